@@ -48,11 +48,20 @@ public:
 	virtual std::streamoff read( su::array_view<uint8_t> o_buffer ) = 0;
 
 	virtual data_format_t format() const = 0;
-	
+
+	//! direct access to the data, only available when no decoding is needed
+	//! and the document is in memory (mapped or user buffer), return false
+	//! otherwise
+	virtual bool view( su::array_view<const uint8_t> &o_view ) const;
+
 	Data readAll();
 
 protected:
 	AbstractDataStream() = default;
+
+	//! decode everything in one go, for a stream that can do better than
+	//! successive read(), return false otherwise
+	virtual bool decodeAll( Data &o_data );
 };
 
 typedef std::unique_ptr<AbstractDataStream> DataStreamRef;
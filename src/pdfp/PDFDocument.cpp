@@ -9,36 +9,42 @@
 
 #include "pdfp/PDFDocument.h"
 #include <string>
+#include <cstring>
 #include <regex>
+#include <atomic>
 #include <cassert>
+#include <exception>
+#include <thread>
+#include <unordered_set>
+#include "impl/Arena.h"
+#include "impl/FileMapping.h"
+#include "impl/FileReader.h"
 #include "impl/Parser.h"
+#include "impl/ReaderStreamBuf.h"
 #include "security/SecurityHandler.h"
 #include "su/log/logger.h"
 
 namespace {
 
-int iterateCountPages( const pdfp::Object &i_pages )
-{
-	int count = 0;
-	if ( i_pages.is_null() )
-		return count;
-
-	auto &kids = i_pages["Kids"];
-	if ( kids.is_null() )
-		return 1;
+//! below this, parsing is not worth a thread
+const size_t kMinObjectsPerThread = 1024;
+//! up to that many object streams are decoded by one thread
+const size_t kMaxSerialObjectStreams = 2;
 
-	if ( not kids.is_array() )
-		return count;
+std::atomic<size_t> gGlobalCacheBudget{0};
 
-	for ( auto &kid : kids.array_items_resolved() )
+//! the Parent entry of a page tree node, not resolved
+const pdfp::Object &parentEntry( const pdfp::Object &i_node )
+{
+	static const pdfp::Name kParent( "Parent" );
+	if ( not i_node.is_dictionary() )
+		return pdfp::kObjectNull;
+	for ( auto &it : i_node.dictionary_items() )
 	{
-		if ( kid.is_null() )
-			continue;
-		if ( not kid.is_dictionary() )
-			continue;
+		if ( it.first == kParent )
+			return it.second;
 	}
-
-	return count;
+	return pdfp::kObjectNull;
 }
 
 std::string parseName( const char *&ptr )
@@ -252,10 +258,10 @@ path_info_result resolvePath( const pdfp::Document *i_doc,
 									res = pdfp_string;
 									if ( o_string != nullptr )
 									{
-										auto &items = current.dictionary_items();
+										auto items = current.dictionary_items();
 										auto it = items.begin();
 										std::advance( it, index );
-										*o_string = it->first;
+										*o_string = it->first.str();
 									}
 								}
 								current.clear();
@@ -290,22 +296,148 @@ namespace pdfp {
 Document::Document() {}
 Document::~Document() {}
 
-void Document::open( const std::string &i_path )
+void Document::useArena( bool i_use )
+{
+	_useArena = i_use;
+}
+
+void Document::useConcurrentAccess( bool i_use )
+{
+	_concurrent = i_use;
+}
+
+void Document::setCacheBudget( size_t i_bytes )
+{
+	_cacheBudget = i_bytes;
+}
+
+void Document::setGlobalCacheBudget( size_t i_bytes )
+{
+	gGlobalCacheBudget.store( i_bytes, std::memory_order_relaxed );
+}
+
+void Document::useIndexCache( const std::string &i_cachePath )
+{
+	_indexCachePath = i_cachePath;
+}
+
+bool Document::flushIndexCache()
+{
+	if ( _indexCachePath.empty() or _indexCacheKey.mtime == 0 or
+	     _parser.get() == nullptr )
+		return false;
+
+	auto lock = parserLock();
+	bool newPages = not _indexCachePages and
+	                _pageIndexReady.load( std::memory_order_acquire );
+	if ( not newPages and
+	     _parser->recoveredLengths().size() == _indexCacheLengths )
+		return true;
+	return saveIndexCache();
+}
+
+void Document::trimCache()
+{
+	auto globalBudget = gGlobalCacheBudget.load( std::memory_order_relaxed );
+	if ( _cacheBudget == 0 and globalBudget == 0 )
+		return;
+
+	auto lock = parserLock();
+	// the decoded object streams hold a copy of their objects
+	if ( _parser.get() != nullptr )
+		_parser->releaseObjectStreams();
+	_xrefTable.trim( _cacheBudget, globalBudget );
+}
+
+std::unique_lock<std::recursive_mutex> Document::parserLock() const
+{
+	if ( _concurrent or _preloading )
+		return std::unique_lock<std::recursive_mutex>( _parserMutex );
+	return {};
+}
+
+void Document::open( const std::string &i_path, open_mode_t i_mode )
+{
+	if ( not _indexCachePath.empty() )
+		_indexCacheKey.mtime = IndexCache::modificationTime( i_path );
+	if ( i_mode == open_mode_t::kMapped )
+	{
+		auto mapping = std::make_unique<FileMapping>();
+		if ( mapping->open( i_path ) )
+		{
+			_data = mapping->data();
+			_size = mapping->size();
+			_mapping = std::move( mapping );
+		}
+		// else fallback to regular reads
+	}
+	if ( _data == nullptr )
+	{
+		auto reader = std::make_unique<FileReader>();
+		if ( reader->open( i_path ) )
+		{
+			_streamBuf = std::make_unique<ReaderStreamBuf>( *reader );
+			_stream = std::make_unique<std::istream>( _streamBuf.get() );
+			_reader = std::move( reader );
+		}
+	}
+	load();
+}
+
+void Document::open( su::array_view<const uint8_t> i_buffer )
+{
+	if ( i_buffer.size() > 0 )
+	{
+		_data = (const char *)i_buffer.data();
+		_size = i_buffer.size();
+	}
+	load();
+}
+
+void Document::open( std::unique_ptr<RandomAccessReader> i_reader )
 {
-	_stream.open( i_path, std::ios_base::in | std::ios_base::binary );
-	if ( not _stream )
+	if ( i_reader.get() != nullptr and i_reader->size() > 0 )
+	{
+		_streamBuf = std::make_unique<ReaderStreamBuf>( *i_reader );
+		_stream = std::make_unique<std::istream>( _streamBuf.get() );
+		_reader = std::move( i_reader );
+	}
+	load();
+}
+
+void Document::load()
+{
+	if ( _data == nullptr and ( _stream.get() == nullptr or not *_stream ) )
 	{
 		// non-readable stream ?
+		closeSource();
 		throw std::runtime_error( "cannot read PDF file" );
 	}
 
+	if ( _useArena and _arena.get() == nullptr )
+	{
+		_arena = std::make_unique<Arena>();
+		// the parser lock is not always held, see preloadObjects()
+		_arena->setShared( _concurrent );
+	}
+
 	try
 	{
-		_parser = std::make_unique<Parser>( _stream, this );
+		// in memory, tokenize the buffer directly
+		if ( _data != nullptr )
+			_parser = std::make_unique<Parser>( _data, _data + _size, this );
+		else
+			_parser = std::make_unique<Parser>( *_stream, this );
+
+		// only for a file opened by path, a buffer or a reader has no
+		// modification time
+		bool useIndexCache =
+		    not _indexCachePath.empty() and _indexCacheKey.mtime != 0;
+		bool fromIndexCache = useIndexCache and loadIndexCache();
 
 		// try twice: first, proper parsing of the file, if that fails, try to
 		// rebuild the file by scaning all of it
-		for ( int i = 0; i < 2; ++i )
+		for ( int i = 0; i < 2 and not fromIndexCache; ++i )
 		{
 			try
 			{
@@ -356,15 +488,28 @@ void Document::open( const std::string &i_path )
 		{
 			loadRoot();
 		}
+
+		if ( useIndexCache and not fromIndexCache )
+			saveIndexCache();
 	}
 	catch ( ... )
 	{
 		_parser.reset();
-		_stream.close();
+		closeSource();
 		throw;
 	}
 }
 
+void Document::closeSource()
+{
+	_stream.reset();
+	_streamBuf.reset();
+	_reader.reset();
+	_mapping.reset();
+	_data = nullptr;
+	_size = 0;
+}
+
 void Document::loadRoot()
 {
 	assert( _catalog.is_null() );
@@ -388,18 +533,206 @@ void Document::loadRoot()
 	if ( not pages.is_dictionary() )
 		throw std::runtime_error( "invalid PDF file" );
 
-	int pageCount = -1;
-	auto &obj = pages["Count"];
-	if ( obj.is_number() )
-		pageCount = obj.int_value();
+	// from the index cache, the pages are resolved on demand
+	if ( not _pageRefs.empty() )
+	{
+		_pageRepository.resize( _pageRefs.size() );
+		_pageIndexReady.store( true, std::memory_order_release );
+	}
+}
+
+void Document::buildPageIndex() const
+{
+	if ( _pageIndexReady.load( std::memory_order_acquire ) )
+		return;
+	auto lock = parserLock();
+	// not before unlock() for an encrypted document
+	if ( _pageIndexReady.load( std::memory_order_relaxed ) or
+	     _catalog.is_null() )
+		return;
+
+	// depth first, without recursion and without trusting Count, a node
+	// already seen is skipped so that a cycle ends the walk
+	struct Level
+	{
+		Object kids;
+		size_t next;
+	};
+	std::vector<Page> pages;
+	std::vector<Object::ObjRef> refs;
+	bool allRefs = true;
+	std::unordered_set<int> visited;
+	std::vector<Level> stack;
+	stack.push_back( {_catalog["Pages"]["Kids"], 0} );
+	while ( not stack.empty() )
+	{
+		auto &level = stack.back();
+		if ( not level.kids.is_array() or
+		     level.next >= level.kids.array_size() )
+		{
+			stack.pop_back();
+			continue;
+		}
+		Object kid = level.kids.array_items()[level.next++];
+		if ( kid.is_ref() and not visited.insert( kid.ref_value().ref ).second )
+			continue;
+		auto &c = resolveIndirect( kid );
+		if ( not c.is_dictionary() )
+			continue;
+
+		// a node is a Pages or, without a type, anything with kids
+		auto &type = c["Type"];
+		auto &kids = c["Kids"];
+		bool isNode = type.is_name() ? type.name_value() == "Pages"
+		                             : kids.is_array();
+		if ( isNode )
+			stack.push_back( {kids, 0} );
+		else
+		{
+			pages.emplace_back( c, nodeAttributes( parentEntry( c ) ) );
+			if ( kid.is_ref() )
+				refs.push_back( kid.ref_value() );
+			else
+				allRefs = false;
+		}
+	}
+
+	_pageRepository = std::move( pages );
+	if ( allRefs )
+		_pageRefs = std::move( refs );
 	else
-		pageCount = iterateCountPages( pages );
+		_pageRefs.clear();
+	_pageIndexReady.store( true, std::memory_order_release );
+}
 
-	_pageRepository.resize( pageCount );
+std::shared_ptr<const PageAttributes> Document::inheritedAttributes(
+    const Object &i_page ) const
+{
+	auto lock = parserLock();
+	return nodeAttributes( parentEntry( i_page ) );
+}
+
+std::shared_ptr<const PageAttributes> Document::nodeAttributes(
+    const Object &i_parent ) const
+{
+	if ( i_parent.is_null() )
+		return nullptr;
+
+	// an indirect node is computed once, a node seen again while being
+	// computed is a cycle in the Parent chain
+	int id = i_parent.is_ref() ? i_parent.ref_value().ref : -1;
+	if ( id >= 0 )
+	{
+		auto it = _nodeAttributes.find( id );
+		if ( it != _nodeAttributes.end() )
+			return it->second;
+		_nodeAttributes[id] = nullptr;
+	}
+
+	auto &node = resolveIndirect( i_parent );
+	if ( not node.is_dictionary() )
+		return nullptr;
+	auto inherited = nodeAttributes( parentEntry( node ) );
+	auto attributes = inherited.get() != nullptr
+	                      ? std::make_shared<PageAttributes>( *inherited )
+	                      : std::make_shared<PageAttributes>();
+	attributes->merge( node );
+	if ( id >= 0 )
+		_nodeAttributes[id] = attributes;
+	return attributes;
 }
 
-void Document::preload()
+bool Document::loadIndexCache()
 {
+	_indexCacheKey.size = _data != nullptr ? _size : _reader->size();
+	uint8_t tail[IndexCache::kTailSize];
+	size_t tailSize = std::min<size_t>( _indexCacheKey.size, sizeof( tail ) );
+	if ( read( _indexCacheKey.size - tailSize, {tail, tailSize} ) !=
+	     std::streamoff( tailSize ) )
+		return false;
+	_indexCacheKey.tailHash = IndexCache::hash( tail, tailSize );
+
+	IndexCache::Content content;
+	if ( not IndexCache::read( _indexCachePath, _indexCacheKey, content ) )
+		return false;
+
+	try
+	{
+		Parser parser( content.trailer.data(),
+		               content.trailer.data() + content.trailer.size(),
+		               this );
+		auto trailer = parser.readDirectObject();
+		if ( not trailer.is_dictionary() )
+			return false;
+
+		_xrefTable.clear();
+		_xrefTable.expand( content.xrefs.size() );
+		for ( size_t i = 0; i < content.xrefs.size(); ++i )
+			_xrefTable[i] = content.xrefs[i];
+		_trailerDict = trailer;
+		_version = content.version;
+		for ( auto &it : content.recoveredLengths )
+			_parser->addRecoveredLength( it.first, it.second );
+		_indexCacheLengths = content.recoveredLengths.size();
+		_indexCachePages = content.pagesKnown;
+		_pageRefs = std::move( content.pages );
+	}
+	catch ( std::exception &ex )
+	{
+		log_warn() << "invalid index cache " << _indexCachePath << ": "
+		           << ex.what();
+		_xrefTable.clear();
+		return false;
+	}
+	return true;
+}
+
+bool Document::saveIndexCache()
+{
+	try
+	{
+		IndexCache::Content content;
+		content.xrefs.reserve( _xrefTable.size() );
+		for ( auto &it : _xrefTable )
+		{
+			if ( it.compressed() )
+				content.xrefs.emplace_back( it.streamId(), it.indexInStream(), true );
+			else
+				content.xrefs.emplace_back( it.generation(), it.pos() );
+		}
+		content.trailer = IndexCache::serialize( _trailerDict );
+		content.version = _version;
+		auto &lengths = _parser->recoveredLengths();
+		content.recoveredLengths.assign( lengths.begin(), lengths.end() );
+
+		// only once built, walking the page tree is left to the caller
+		content.pagesKnown = _pageIndexReady.load( std::memory_order_acquire );
+		if ( content.pagesKnown )
+			content.pages = _pageRefs;
+
+		if ( IndexCache::write( _indexCachePath, _indexCacheKey, content ) )
+		{
+			_indexCacheLengths = content.recoveredLengths.size();
+			_indexCachePages = content.pagesKnown;
+			return true;
+		}
+		log_warn() << "cannot write index cache " << _indexCachePath;
+	}
+	catch ( std::exception &ex )
+	{
+		log_warn() << "cannot write index cache " << _indexCachePath << ": "
+		           << ex.what();
+	}
+	return false;
+}
+
+void Document::preload( size_t i_nbThreads )
+{
+	// more threads than cores only adds contention on the parser lock
+	size_t nbCores = std::max( 1u, std::thread::hardware_concurrency() );
+	if ( i_nbThreads == 0 or i_nbThreads > nbCores )
+		i_nbThreads = nbCores;
+
 	std::vector<int> objectIndexes;
 	objectIndexes.reserve( _xrefTable.size() );
 
@@ -421,8 +754,7 @@ void Document::preload()
 				} );
 	
 	// 3- load all
-	for ( auto it : objectIndexes )
-		_xrefTable.registerObject( it, _parser->readObject( it ) );
+	preloadObjects( objectIndexes, false, i_nbThreads );
 	objectIndexes.clear();
 
 	// the compressed objects
@@ -443,8 +775,125 @@ void Document::preload()
 				} );
 
 	// 3- load all
-	for ( auto it : objectIndexes )
-		_xrefTable.registerObject( it, _parser->readObject( it ) );
+	preloadObjects( objectIndexes, true, i_nbThreads );
+}
+
+void Document::preloadObjects( const std::vector<int> &i_ids,
+                               bool i_byStream,
+                               size_t i_nbThreads )
+{
+	if ( _parser.get() == nullptr )
+		return;
+
+	size_t nbParts =
+	    std::min( i_nbThreads, i_ids.size() / kMinObjectsPerThread );
+	if ( i_byStream and nbParts > 1 )
+	{
+		// an object stream is decoded by a single thread
+		size_t nbStreams = 0;
+		for ( size_t i = 0; i < i_ids.size(); ++i )
+		{
+			if ( i == 0 or _xrefTable[i_ids[i]].streamId() !=
+			                   _xrefTable[i_ids[i - 1]].streamId() )
+				++nbStreams;
+		}
+		if ( nbStreams <= kMaxSerialObjectStreams )
+			nbParts = 1;
+		else
+			nbParts = std::min( nbParts, nbStreams );
+	}
+	if ( nbParts <= 1 )
+	{
+		auto lock = parserLock();
+		for ( auto it : i_ids )
+			_xrefTable.registerObject( it, _parser->readObject( it ) );
+		return;
+	}
+
+	// contiguous parts of about the same size, an object stream is never
+	// split so that it is decoded once
+	std::vector<size_t> bounds( 1, 0 );
+	size_t partSize = i_ids.size() / nbParts;
+	for ( size_t i = 1; i < nbParts; ++i )
+	{
+		size_t b = std::max( bounds.back(), i * partSize );
+		while ( i_byStream and b > 0 and b < i_ids.size() and
+		        _xrefTable[i_ids[b]].streamId() ==
+		            _xrefTable[i_ids[b - 1]].streamId() )
+			++b;
+		bounds.push_back( b );
+	}
+	bounds.push_back( i_ids.size() );
+
+	// each thread has its own parser, the objects they need to resolve
+	// go through the document parser, under its lock
+	_preloading = true;
+	if ( not _concurrent )
+	{
+		// the objects already there were not made for several threads, the
+		// workers reach them through resolveIndirect() and copy them
+		_trailerDict.share();
+		for ( auto &it : _xrefTable )
+			it.object().share();
+		if ( _arena.get() != nullptr )
+			_arena->setShared( true );
+	}
+
+	std::vector<Object> results( i_ids.size() );
+	std::vector<std::exception_ptr> errors( nbParts );
+	// what guessStreamLength() found in each thread
+	std::vector<su::flat_map<size_t, size_t>> lengths( nbParts );
+	std::vector<std::thread> threads;
+	for ( size_t i = 0; i < nbParts; ++i )
+	{
+		threads.emplace_back( [this, i, &i_ids, &bounds, &results, &errors,
+		                       &lengths]() {
+			try
+			{
+				std::unique_ptr<ReaderStreamBuf> streamBuf;
+				std::unique_ptr<std::istream> stream;
+				std::unique_ptr<Parser> parser;
+				if ( _data != nullptr )
+					parser = std::make_unique<Parser>( _data, _data + _size, this );
+				else
+				{
+					streamBuf = std::make_unique<ReaderStreamBuf>( *_reader );
+					stream = std::make_unique<std::istream>( streamBuf.get() );
+					parser = std::make_unique<Parser>( *stream, this );
+				}
+				for ( size_t j = bounds[i]; j < bounds[i + 1]; ++j )
+					results[j] = parser->readObject( i_ids[j] );
+				lengths[i] = parser->recoveredLengths();
+			}
+			catch ( ... )
+			{
+				errors[i] = std::current_exception();
+			}
+		} );
+	}
+	for ( auto &it : threads )
+		it.join();
+
+	if ( _arena.get() != nullptr and not _concurrent )
+		_arena->setShared( false );
+
+	{
+		auto lock = parserLock();
+		_preloading = false;
+		for ( size_t i = 0; i < i_ids.size(); ++i )
+			_xrefTable.registerObject( i_ids[i], results[i] );
+		for ( auto &part : lengths )
+		{
+			for ( auto &it : part )
+				_parser->addRecoveredLength( it.first, it.second );
+		}
+	}
+
+	for ( auto &it : errors )
+	{
+		if ( it )
+			std::rethrow_exception( it );
+	}
 }
 
 Version Document::version() const
@@ -487,20 +936,23 @@ bool Document::isUnlocked() const
 
 size_t Document::nbOfPages() const
 {
+	buildPageIndex();
 	return _pageRepository.size();
 }
 
 Page Document::page( size_t i_index ) const
 {
-	if ( i_index > _pageRepository.size() )
+	buildPageIndex();
+	if ( i_index >= _pageRepository.size() )
 		return {};
-	if ( _pageRepository[i_index].is_null() )
+	auto lock = parserLock();
+	auto &page = _pageRepository[i_index];
+	if ( page.is_null() and i_index < _pageRefs.size() )
 	{
-		auto pages = _catalog["Pages"];
-		auto page = navigateToPage( pages, i_index );
-		_pageRepository[i_index] = page;
+		auto &ref = _pageRefs[i_index];
+		page = Page( resolveIndirect( Object::create_ref( ref.ref, ref.gen ) ) );
 	}
-	return { _pageRepository[i_index] };
+	return page;
 }
 
 const Object &Document::catalog() const
@@ -528,7 +980,7 @@ std::string Document::decrypt( const std::string &i_input,
 std::pair<std::string,std::string> Document::getFileID() const
 {
 	std::pair<std::string,std::string> ids;
-	auto &fileID = _trailerDict["ID"].array_items();
+	auto fileID = _trailerDict["ID"].array_items();
 	if ( fileID.size() > 0 )
 		ids.first = fileID[0].string_value();
 	if ( fileID.size() > 1 )
@@ -536,49 +988,6 @@ std::pair<std::string,std::string> Document::getFileID() const
 	return ids;
 }
 
-Object Document::navigateToPage( const Object &pages,
-                                                   size_t i_page ) const
-{
-	if ( not pages.is_dictionary() )
-		return kObjectNull;
-	auto kids = pages["Kids"];
-	if ( not kids.is_array() )
-		return kObjectNull;
-
-	for ( auto &c : kids.array_items_resolved() )
-	{
-		if ( not c.is_dictionary() )
-			return kObjectNull;
-		auto &type = c["Type"];
-		if ( not type.is_name() )
-			return kObjectNull;
-		if ( type.name_value() == "Page" )
-		{
-			if ( i_page == 0 )
-				return c;
-			else
-				--i_page;
-		}
-		else
-		{
-			int pageCount = -1;
-			auto count = c["Count"];
-			if ( not count.is_null() )
-			{
-				if ( count.is_number() )
-					pageCount = count.int_value();
-			}
-			if ( pageCount == -1 )
-				pageCount = iterateCountPages( c );
-			if ( pageCount <= i_page )
-				i_page -= pageCount;
-			else
-				return navigateToPage( c, i_page );
-		}
-	}
-	return kObjectNull;
-}
-
 const Object &Document::resolveIndirect( const Object &i_obj ) const
 {
 	if ( not i_obj.is_ref() )
@@ -588,6 +997,11 @@ const Object &Document::resolveIndirect( const Object &i_obj ) const
 	const auto &loaded = _xrefTable.resolveRef( objRef.ref, objRef.gen );
 	if ( loaded.is_null() and _parser.get() != nullptr )
 	{
+		auto lock = parserLock();
+		// another thread may have published it while we waited
+		if ( lock.owns_lock() and size_t( objRef.ref ) < _xrefTable.size() and
+		     _xrefTable[objRef.ref].loaded() )
+			return _xrefTable.resolveRef( objRef.ref, objRef.gen );
 		auto obj = _parser->readObject( objRef.ref );
 		return _xrefTable.registerObject( objRef.ref, obj );
 	}
@@ -597,7 +1011,23 @@ const Object &Document::resolveIndirect( const Object &i_obj ) const
 std::streamoff Document::read( size_t i_pos,
                                    su::array_view<uint8_t> o_buffer ) const
 {
-	return _parser->read( i_pos, o_buffer );
+	if ( _data != nullptr )
+	{
+		if ( i_pos >= _size )
+			return EOF;
+		size_t l = std::min( o_buffer.size(), _size - i_pos );
+		memcpy( o_buffer.data(), _data + i_pos, l );
+		return l;
+	}
+	// positional read, no shared file position
+	return _reader->read( i_pos, o_buffer );
+}
+
+const char *Document::memoryData( size_t i_pos, size_t i_len ) const
+{
+	if ( _data == nullptr or i_pos > _size or i_len > ( _size - i_pos ) )
+		return nullptr;
+	return _data + i_pos;
 }
 
 std::unique_ptr<Crypter> Document::createCrypter( bool i_isMetadata,
@@ -736,8 +1166,23 @@ size_t Document::mem_size() const
 {
 	size_t s = sizeof( Document );
 	s += _trailerDict.mem_size();
-	s += _catalog.mem_size();
+	// the catalog is in the trailer or in its xref slot, which _catalog
+	// pins in the cache
+	s += _xrefTable.cacheSize();
 	return s;
 }
 
+Document::MemoryReport Document::memory_report() const
+{
+	MemoryReport report;
+	report.objects = mem_size();
+	report.cache = _xrefTable.cacheSize();
+	if ( _arena.get() != nullptr )
+	{
+		report.arenaUsed = _arena->used();
+		report.arenaReserved = _arena->reserved();
+	}
+	return report;
+}
+
 }
@@ -12,9 +12,12 @@
 
 #include "PDFObject.h"
 #include "PDFPage.h"
+#include "PDFReader.h"
 #include "su/containers/flat_map.h"
+#include "impl/IndexCache.h"
 #include "impl/XrefTable.h"
-#include <fstream>
+#include <istream>
+#include <mutex>
 
 namespace pdfp {
 
@@ -23,7 +26,16 @@ struct Version
 	int major{0}, minor{0};
 };
 
+//! how the file content is accessed
+enum class open_mode_t
+{
+	kStream, //!< regular file reads
+	kMapped //!< memory mapped, unfiltered stream data is accessed in place
+};
+
+class Arena;
 class DocSource;
+class FileMapping;
 class Crypter;
 class SecurityHandler;
 class Parser;
@@ -40,14 +52,100 @@ public:
 	Document();
 	~Document();
 
-	void open( const std::string &i_path );
-	void preload();
+	/*!
+	   @brief allocate the parsed objects from a per document arena.
+
+	       Must be called before open(). The objects and their array and
+	   dictionary entries are never destroyed one by one, the arena is
+	   released at once with the document. Objects from it must not outlive
+	   the document.
+	*/
+	void useArena( bool i_use = true );
+	/*!
+	   @brief share the document between threads.
+
+	       Must be called before open(). The objects are then reference
+	   counted atomically and the objects read on demand are parsed under a
+	   lock and published once, so that the const methods can be called from
+	   any thread. The objects themselves are never modified once published.
+	   trimCache() is the exception, see there.
+	*/
+	void useConcurrentAccess( bool i_use = true );
+	bool concurrentAccess() const { return _concurrent; }
+
+	/*!
+	   @brief limit the memory held by the parsed objects.
+
+	       The budget is not enforced by the document: nothing is evicted
+	   until the caller calls trimCache(), at a point where no object of the
+	   document is in use. Then the least recently used objects are evicted,
+	   they are parsed again when needed. An object that is held elsewhere (a
+	   copy of the Object) is pinned and stays. With an arena, the memory of
+	   the evicted objects is only given back with the document.
+	   @param i_bytes the budget, 0 for no limit
+	*/
+	void setCacheBudget( size_t i_bytes );
+	//! same, for every document together
+	static void setGlobalCacheBudget( size_t i_bytes );
+	/*!
+	   @brief evict objects until under the budgets.
+
+	       NOT THREAD SAFE, even in concurrent mode: every other thread using
+	   the document must be stopped for the duration of the call. Evicting
+	   from the accessors or after preload() would break the references
+	   they return, so the document never calls it on its own.
+
+	       The references returned by the accessors (const Object &) are not
+	   pins, no reference to an object of the document must be held.
+	*/
+	void trimCache();
+
+	/*!
+	   @brief keep what open() parses in a sidecar file.
+
+	       Must be called before open( path ). When the file at i_cachePath
+	   was written for the same PDF file (same size, modification time and
+	   trailing bytes), the xref table, the trailer and the page list are
+	   read from it instead of being parsed. Otherwise it is written once the
+	   document is open, without the page list unless it is already built.
+	*/
+	void useIndexCache( const std::string &i_cachePath );
+	/*!
+	   @brief add to the index cache what was found since it was written.
+
+	       The stream lengths recovered since open() and the page list once
+	   nbOfPages() or page() built it. Nothing is written when there is
+	   nothing new. Never called by the document itself, the destructor does
+	   not write.
+	   @return false if there is no index cache or it cannot be written
+	*/
+	bool flushIndexCache();
+
+	void open( const std::string &i_path,
+	           open_mode_t i_mode = open_mode_t::kStream );
+	//! open a PDF file already in memory, the buffer is not copied and must
+	//! stay valid for the lifetime of the document
+	void open( su::array_view<const uint8_t> i_buffer );
+	//! open a PDF file through a custom reader
+	void open( std::unique_ptr<RandomAccessReader> i_reader );
+	/*!
+	   @brief parse every object now instead of on demand.
+
+	       Objects are parsed in file order, the compressed ones by object
+	   stream. With several threads, each one parses a range of the file or
+	   a set of object streams with its own parser. Never more threads than
+	   cores, and a single one for one or two object streams.
+	   @param i_nbThreads number of threads, 0 for one per core
+	*/
+	void preload( size_t i_nbThreads = 1 );
 
 	// interface
 	Version version() const;
 	bool isEncrypted() const;
 	bool unlock( const std::string &i_password );
 	bool isUnlocked() const;
+	//! nbOfPages() and page() walk the whole page tree on first use, the
+	//! root Count is not trusted so the two always agree
 	size_t nbOfPages() const;
 	Page page( size_t i_index ) const;
 	const Object &catalog() const;
@@ -80,9 +178,36 @@ public:
 	const Object &resolveIndirect( const Object &i_obj ) const;
 
 	size_t mem_size() const;
-	
+
+	struct MemoryReport
+	{
+		size_t objects{0}; //!< mem_size() of the document
+		size_t arenaUsed{0}; //!< bytes handed out by the arena
+		size_t arenaReserved{0}; //!< bytes held by the arena
+		size_t cache{0}; //!< bytes held by the parsed objects
+	};
+	MemoryReport memory_report() const;
+
 private:
-	std::ifstream _stream;
+	bool _useArena = false;
+	bool _concurrent = false;
+	//! a parallel preload is running, objects are shared like in
+	//! concurrent mode
+	bool _preloading = false;
+	size_t _cacheBudget = 0;
+	//! serialize the parser in concurrent mode, recursive because parsing
+	//! an object can resolve others (a stream length, an object stream)
+	mutable std::recursive_mutex _parserMutex;
+	//! first, so that it goes away after every object it holds
+	std::unique_ptr<Arena> _arena;
+	std::unique_ptr<FileMapping> _mapping;
+	std::unique_ptr<RandomAccessReader> _reader;
+	//! the whole file when in memory (mapped or user buffer)
+	const char *_data = nullptr;
+	size_t _size = 0;
+	//! only used when the file is not in memory
+	std::unique_ptr<std::streambuf> _streamBuf;
+	std::unique_ptr<std::istream> _stream;
 	//! the xref table, all indirect objects are stored here
 	XrefTable _xrefTable;
 	std::unique_ptr<Parser> _parser;
@@ -94,11 +219,40 @@ private:
 
 	std::string _version;
 
-	mutable std::vector<Object> _pageRepository;
+	//! the pages in order, built once by buildPageIndex()
+	mutable std::vector<Page> _pageRepository;
+	//! the page objects, when every page is an indirect object
+	mutable std::vector<Object::ObjRef> _pageRefs;
+	mutable std::atomic<bool> _pageIndexReady{false};
+	//! page tree node -> what it passes to its kids, null while computed
+	mutable su::flat_map<int, std::shared_ptr<const PageAttributes>>
+	    _nodeAttributes;
+
+	std::string _indexCachePath;
+	IndexCache::Key _indexCacheKey;
+	//! number of recovered stream lengths in the index cache
+	size_t _indexCacheLengths = 0;
+	//! the index cache has the page list
+	bool _indexCachePages = false;
 
+	void load();
+	void closeSource();
+	//! the parser lock in concurrent mode, a lock that owns nothing otherwise
+	std::unique_lock<std::recursive_mutex> parserLock() const;
+	//! parse and register the objects i_ids, in order
+	void preloadObjects( const std::vector<int> &i_ids,
+	                     bool i_byStream,
+	                     size_t i_nbThreads );
 	void loadRoot();
+	//! false if there is no usable index cache
+	bool loadIndexCache();
+	bool saveIndexCache();
 
+	//! read at a given position, does not touch the parser and can be
+	//! called from any thread
 	std::streamoff read( size_t i_pos, su::array_view<uint8_t> o_buffer ) const;
+	//! direct access to the file content, nullptr if not in memory
+	const char *memoryData( size_t i_pos, size_t i_len ) const;
 	
 	std::string decrypt( const std::string &i_input,
 	                     int i_id,
@@ -109,10 +263,18 @@ private:
 
 	XrefTable &xrefTable() { return _xrefTable; }
 
-	Object navigateToPage( const Object &pages,
-	                                     size_t i_page ) const;
+	//! flatten the page tree into _pageRepository
+	void buildPageIndex() const;
+	//! what the page i_page inherits from its parent nodes
+	std::shared_ptr<const PageAttributes> inheritedAttributes(
+	    const Object &i_page ) const;
+	//! same for a kid of i_parent, the Parent entry as found in the kid
+	std::shared_ptr<const PageAttributes> nodeAttributes(
+	    const Object &i_parent ) const;
 
 	friend class DocSource;
+	friend class Object;
+	friend class Page;
 	friend class Parser;
 	friend DataStreamRef createDataStream( const Object &,
                                 size_t,
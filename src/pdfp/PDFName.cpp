@@ -0,0 +1,221 @@
+/*
+ *  PDFName.cpp
+ *  pdfp
+ *
+ *  Created by Sandy Martel on 2026-10-17.
+ *  Copyright 2026 Sandy Martel. All rights reserved.
+ *
+ */
+
+#include "pdfp/PDFName.h"
+#include "impl/Keywords.h"
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+
+namespace pdfp {
+
+namespace details {
+
+struct alignas( 8 ) NameEntry
+{
+	std::atomic<size_t> refCount{1};
+	size_t len;
+	//! never released, not reference counted
+	bool permanent{false};
+	char buf[1];
+
+	std::string_view view() const { return {buf, len}; }
+};
+
+//! the table is split by hash, names interned by different threads
+//! rarely wait on the same lock
+const size_t kNbShards = 64;
+
+struct alignas( 64 ) NameShard
+{
+	std::mutex mutex;
+	std::unordered_map<std::string_view, NameEntry *> entries;
+};
+
+struct NameTable
+{
+	NameShard shards[kNbShards];
+
+	NameShard &shard( const std::string_view &i_value )
+	{
+		auto h = std::hash<std::string_view>()( i_value );
+		// not the low bits, the shard map uses them for its buckets
+		return shards[( h >> 16 ) % kNbShards];
+	}
+};
+
+NameTable &nameTable()
+{
+	// never destroyed, names in static objects can outlive it
+	static auto table = new NameTable;
+	return *table;
+}
+
+NameEntry *newEntry( const std::string_view &i_value )
+{
+	auto ptr = ::malloc( sizeof( NameEntry ) + i_value.size() );
+	auto entry = new ( ptr ) NameEntry;
+	entry->len = i_value.size();
+	memcpy( entry->buf, i_value.data(), i_value.size() );
+	entry->buf[entry->len] = 0;
+	return entry;
+}
+
+//! one permanent entry per standard name, indexed by Keyword
+std::array<NameEntry *, kNbKeywords> makeWellKnownEntries()
+{
+	std::array<NameEntry *, kNbKeywords> entries{};
+	for ( size_t i = 1; i < kNbKeywords; ++i )
+	{
+		entries[i] = newEntry( kKeywordNames[i] );
+		entries[i]->permanent = true;
+	}
+	return entries;
+}
+}
+
+using namespace details;
+
+Name::Name( const std::string_view &i_value ) :
+    _entry( i_value.empty() ? nullptr : intern( i_value ) )
+{
+}
+
+Name::~Name()
+{
+	release( _entry );
+}
+
+Name::Name( const Name &rhs ) noexcept :
+    _entry( rhs._entry )
+{
+	retain( _entry );
+}
+
+Name &Name::operator=( const Name &rhs ) noexcept
+{
+	if ( _entry != rhs._entry )
+	{
+		retain( rhs._entry );
+		release( _entry );
+		_entry = rhs._entry;
+	}
+	return *this;
+}
+
+Name::Name( Name &&rhs ) noexcept :
+    _entry( std::exchange( rhs._entry, nullptr ) )
+{
+}
+
+Name &Name::operator=( Name &&rhs ) noexcept
+{
+	if ( this != &rhs )
+	{
+		release( _entry );
+		_entry = std::exchange( rhs._entry, nullptr );
+	}
+	return *this;
+}
+
+std::string_view Name::view() const
+{
+	return view( _entry );
+}
+
+size_t Name::tableSize()
+{
+	size_t size = 0;
+	for ( auto &shard : nameTable().shards )
+	{
+		std::lock_guard<std::mutex> lock( shard.mutex );
+		size += shard.entries.size();
+	}
+	return size;
+}
+
+NameEntry *Name::wellKnown( const std::string_view &i_value )
+{
+	static const auto entries = makeWellKnownEntries();
+	return entries[size_t( keyword( i_value ) )];
+}
+
+NameEntry *Name::intern( const std::string_view &i_value )
+{
+	// the standard names skip the table and its lock
+	if ( auto entry = wellKnown( i_value ) )
+		return entry;
+
+	auto &shard = nameTable().shard( i_value );
+	std::lock_guard<std::mutex> lock( shard.mutex );
+	auto it = shard.entries.find( i_value );
+	if ( it != shard.entries.end() )
+	{
+		// take a reference, unless the last one is being released
+		auto entry = it->second;
+		size_t count = entry->refCount.load();
+		while ( count != 0 and
+		        not entry->refCount.compare_exchange_weak( count, count + 1 ) )
+			;
+		if ( count != 0 )
+			return entry;
+		shard.entries.erase( it );
+	}
+
+	auto entry = newEntry( i_value );
+	shard.entries.emplace( entry->view(), entry );
+	return entry;
+}
+
+void Name::retain( NameEntry *i_entry )
+{
+	if ( i_entry != nullptr and not i_entry->permanent )
+		i_entry->refCount.fetch_add( 1, std::memory_order_relaxed );
+}
+
+void Name::release( NameEntry *i_entry )
+{
+	if ( i_entry == nullptr or i_entry->permanent or
+	     i_entry->refCount.fetch_sub( 1, std::memory_order_acq_rel ) != 1 )
+		return;
+
+	// a new entry may already have replaced this one
+	auto &shard = nameTable().shard( i_entry->view() );
+	{
+		std::lock_guard<std::mutex> lock( shard.mutex );
+		auto it = shard.entries.find( i_entry->view() );
+		if ( it != shard.entries.end() and it->second == i_entry )
+			shard.entries.erase( it );
+	}
+	i_entry->~NameEntry();
+	::free( i_entry );
+}
+
+bool Name::counted( const NameEntry *i_entry )
+{
+	return i_entry != nullptr and not i_entry->permanent;
+}
+
+std::string_view Name::view( const NameEntry *i_entry )
+{
+	return i_entry != nullptr ? i_entry->view() : std::string_view{};
+}
+
+std::ostream &operator<<( std::ostream &o, const Name &i_name )
+{
+	return o << i_name.view();
+}
+}
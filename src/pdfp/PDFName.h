@@ -0,0 +1,107 @@
+/*
+ *  PDFName.h
+ *  pdfp
+ *
+ *  Created by Sandy Martel on 2026-10-17.
+ *  Copyright 2026 Sandy Martel. All rights reserved.
+ *
+ */
+
+#ifndef H_PDFP_PDFNAME
+#define H_PDFP_PDFNAME
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace pdfp {
+
+namespace details {
+struct NameEntry;
+}
+
+/*!
+ @brief An interned PDF name.
+
+    Equal names share one storage for the whole process, so comparing 2
+    names for equality compares 2 pointers. The storage is released with
+    the last name that uses it, except for the standard names (keys,
+    filters, operators) that are allocated once and never counted. Names
+    can be created and destroyed from any thread.
+*/
+class Name final
+{
+public:
+	Name() noexcept = default; //!< the empty name
+	explicit Name( const std::string_view &i_value );
+	~Name();
+
+	Name( const Name &rhs ) noexcept;
+	Name &operator=( const Name &rhs ) noexcept;
+	Name( Name &&rhs ) noexcept;
+	Name &operator=( Name &&rhs ) noexcept;
+
+	std::string_view view() const;
+	std::string str() const { return std::string( view() ); }
+	operator std::string_view() const { return view(); }
+	bool empty() const { return _entry == nullptr; }
+	size_t size() const { return view().size(); }
+
+	bool operator==( const Name &rhs ) const { return _entry == rhs._entry; }
+	bool operator!=( const Name &rhs ) const { return _entry != rhs._entry; }
+	bool operator==( const std::string_view &rhs ) const
+	{
+		return view() == rhs;
+	}
+	bool operator!=( const std::string_view &rhs ) const
+	{
+		return view() != rhs;
+	}
+	//! same order as the strings
+	bool operator<( const Name &rhs ) const
+	{
+		return _entry != rhs._entry and view() < rhs.view();
+	}
+
+	//! number of distinct names alive, not counting the standard names
+	static size_t tableSize();
+
+private:
+	details::NameEntry *_entry = nullptr;
+
+	//! the permanent entry of a standard name, nullptr for other names
+	static details::NameEntry *wellKnown( const std::string_view &i_value );
+	static details::NameEntry *intern( const std::string_view &i_value );
+	static void retain( details::NameEntry *i_entry );
+	static void release( details::NameEntry *i_entry );
+	//! false for a standard name, retain() and release() do nothing
+	static bool counted( const details::NameEntry *i_entry );
+	static std::string_view view( const details::NameEntry *i_entry );
+
+	friend class Object;
+};
+
+//! order names like their strings, so that a lookup by string does not
+//! need to intern it
+struct NameLess
+{
+	using is_transparent = void;
+
+	bool operator()( const Name &lhs, const Name &rhs ) const
+	{
+		return lhs < rhs;
+	}
+	bool operator()( const Name &lhs, const std::string_view &rhs ) const
+	{
+		return lhs.view() < rhs;
+	}
+	bool operator()( const std::string_view &lhs, const Name &rhs ) const
+	{
+		return lhs < rhs.view();
+	}
+};
+
+std::ostream &operator<<( std::ostream &o, const Name &i_name );
+}
+
+#endif
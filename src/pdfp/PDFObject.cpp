@@ -11,9 +11,13 @@
 #include "su/base/endian.h"
 #include "su/strings/str_ext.h"
 #include "pdfp/PDFDocument.h"
+#include "impl/Arena.h"
 #include "impl/DataFactory.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <iostream>
+#include <memory>
 
 namespace pdfp {
 
@@ -94,17 +98,17 @@ inline bool isPtr( uint64_t tag )
 	return ( tag & 0x7 ) == 0 and tag != 0;
 }
 
-struct Statics
+//! interned name, the tag is in the low bits of the entry pointer
+const int kNameAtomTag = 7;
+
+inline bool isAtom( uint64_t tag )
 {
-	const Object::array empty_array;
-	const Object::dictionary empty_dictionary{};
-	Statics() {}
-};
+	return ( tag & 0x7 ) == kNameAtomTag;
+}
 
-const Statics &statics()
+inline NameEntry *atomEntry( uint64_t tag )
 {
-	static const Statics s{};
-	return s;
+	return (NameEntry *)uintptr_t( tag & ~uint64_t( 0x7 ) );
 }
 
 struct alignas(8) ObjectValue
@@ -113,16 +117,36 @@ struct alignas(8) ObjectValue
 
 	virtual ~ObjectValue() = default;
 
-	mutable size_t refCount{1};
-	void inc() const { ++refCount; }
+	//! atomic operations only when the value can be seen by several threads
+	mutable std::atomic<size_t> refCount{1};
+	void inc() const
+	{
+		if ( shared )
+			refCount.fetch_add( 1, std::memory_order_relaxed );
+		else
+			refCount.store( refCount.load( std::memory_order_relaxed ) + 1,
+			                std::memory_order_relaxed );
+	}
 	void dec() const
 	{
-		--refCount;
-		if ( refCount == 0 )
+		size_t count;
+		if ( shared )
+			count = refCount.fetch_sub( 1, std::memory_order_acq_rel ) - 1;
+		else
+		{
+			count = refCount.load( std::memory_order_relaxed ) - 1;
+			refCount.store( count, std::memory_order_relaxed );
+		}
+		// a value in the arena is never destroyed on its own, what it holds
+		// outside of the arena was handed over to it, see Object::adopt()
+		if ( count == 0 and not inArena )
 			delete this;
 	}
 
 	const Object::Type type;
+	bool inArena{false};
+	//! the document is in concurrent mode
+	bool shared{false};
 
 	void *operator new( std::size_t len ) { return ::malloc( len ); }
 	void *operator new( std::size_t count, void *ptr ) { return ptr; }
@@ -141,7 +165,9 @@ private:
 
 public:
 	static StringStorage *alloc( Object::Type i_type,
-	                             const std::string_view &i_value );
+	                             const std::string_view &i_value,
+	                             Arena *i_arena,
+	                             bool i_shared );
 
 	size_t len;
 	char buf[1];
@@ -149,12 +175,17 @@ public:
 	virtual size_t mem_size() const;
 };
 StringStorage *StringStorage::alloc( Object::Type i_type,
-                                     const std::string_view &i_value )
+                                     const std::string_view &i_value,
+                                     Arena *i_arena,
+                                     bool i_shared )
 {
 	auto needed = sizeof( StringStorage ) + i_value.size();
 
-	auto ptr = ::malloc( needed );
+	auto ptr = i_arena != nullptr ? i_arena->allocate( needed )
+	                               : ::malloc( needed );
 	auto ss = new ( ptr ) StringStorage( i_type );
+	ss->inArena = i_arena != nullptr;
+	ss->shared = i_shared;
 
 	ss->len = i_value.size();
 	std::copy( i_value.begin(), i_value.end(), ss->buf );
@@ -165,56 +196,144 @@ size_t StringStorage::mem_size() const
 {
 	return sizeof( StringStorage ) + len;
 }
-struct Array : ObjectValue
+//! memory for a value and i_extra bytes after it, in the arena if there
+//! is one
+void *allocValue( size_t i_len, size_t i_extra, Arena *i_arena )
+{
+	return i_arena != nullptr ? i_arena->allocate( i_len + i_extra )
+	                          : ::malloc( i_len + i_extra );
+}
+
+//! the elements follow the value in the same allocation
+struct Array final : ObjectValue
 {
 	Document *_doc;
-	Object::array value;
-	Array( Document *i_doc, const Object::array &i_value ) :
-	    ObjectValue( Object::Type::k_array ),
-	    _doc( i_doc ),
-	    value( i_value )
+	size_t _size;
+
+	//! i_size null elements
+	static Array *alloc( Document *i_doc,
+	                     size_t i_size,
+	                     Arena *i_arena,
+	                     bool i_shared );
+	~Array();
+
+	Object *items() { return reinterpret_cast<Object *>( this + 1 ); }
+	const Object *items() const
 	{
+		return reinterpret_cast<const Object *>( this + 1 );
 	}
-	Array( Document *i_doc, Object::array &&i_value ) :
+
+	virtual size_t mem_size() const;
+
+private:
+	Array( Document *i_doc, size_t i_size ) :
 	    ObjectValue( Object::Type::k_array ),
 	    _doc( i_doc ),
-	    value( std::move( i_value ) )
+	    _size( i_size )
 	{
 	}
-	virtual size_t mem_size() const;
 };
+static_assert( sizeof( Array ) % alignof( Object ) == 0, "" );
 
+Array *Array::alloc( Document *i_doc,
+                     size_t i_size,
+                     Arena *i_arena,
+                     bool i_shared )
+{
+	auto ptr =
+	    allocValue( sizeof( Array ), i_size * sizeof( Object ), i_arena );
+	auto arr = new ( ptr ) Array( i_doc, i_size );
+	arr->inArena = i_arena != nullptr;
+	arr->shared = i_shared;
+	std::uninitialized_value_construct_n( arr->items(), i_size );
+	return arr;
+}
+Array::~Array()
+{
+	std::destroy_n( items(), _size );
+}
 size_t Array::mem_size() const
 {
 	size_t s = sizeof( Array );
-	for ( auto &it : value )
-		s += it.mem_size();
+	for ( size_t i = 0; i < _size; ++i )
+		s += items()[i].mem_size();
 	return s;
 }
 
-struct Dictionary : ObjectValue
+//! the entries follow the value in the same allocation, sorted by key
+struct Dictionary final : ObjectValue
 {
 	Document *_doc;
-	Object::dictionary value;
-	Dictionary( Document *i_doc, const Object::dictionary &i_value ) :
-	    ObjectValue( Object::Type::k_dictionary ),
-	    _doc( i_doc ),
-	    value( i_value )
+	size_t _size;
+
+	//! i_size entries with empty keys
+	static Dictionary *alloc( Document *i_doc,
+	                          size_t i_size,
+	                          Arena *i_arena,
+	                          bool i_shared );
+	~Dictionary();
+
+	Object::dictionary_entry *entries()
 	{
+		return reinterpret_cast<Object::dictionary_entry *>( this + 1 );
 	}
-	Dictionary( Document *i_doc, Object::dictionary &&i_value ) :
+	const Object::dictionary_entry *entries() const
+	{
+		return reinterpret_cast<const Object::dictionary_entry *>( this + 1 );
+	}
+	//! the entry for i_key, or nullptr
+	template <typename KEY>
+	const Object::dictionary_entry *find( const KEY &i_key ) const
+	{
+		auto end = entries() + _size;
+		auto it = std::lower_bound(
+		    entries(),
+		    end,
+		    i_key,
+		    []( const Object::dictionary_entry &lhs, const KEY &rhs ) {
+			    return NameLess()( lhs.first, rhs );
+		    } );
+		return it != end and it->first == i_key ? it : nullptr;
+	}
+
+	virtual size_t mem_size() const;
+
+private:
+	Dictionary( Document *i_doc, size_t i_size ) :
 	    ObjectValue( Object::Type::k_dictionary ),
 	    _doc( i_doc ),
-	    value( std::move( i_value ) )
+	    _size( i_size )
 	{
 	}
-	virtual size_t mem_size() const;
 };
+static_assert( sizeof( Dictionary ) % alignof( Object::dictionary_entry ) ==
+                   0,
+               "" );
+
+Dictionary *Dictionary::alloc( Document *i_doc,
+                               size_t i_size,
+                               Arena *i_arena,
+                               bool i_shared )
+{
+	auto ptr = allocValue( sizeof( Dictionary ),
+	                       i_size * sizeof( Object::dictionary_entry ),
+	                       i_arena );
+	auto dict = new ( ptr ) Dictionary( i_doc, i_size );
+	dict->inArena = i_arena != nullptr;
+	dict->shared = i_shared;
+	std::uninitialized_value_construct_n( dict->entries(), i_size );
+	return dict;
+}
+Dictionary::~Dictionary()
+{
+	std::destroy_n( entries(), _size );
+}
 size_t Dictionary::mem_size() const
 {
 	size_t s = sizeof( Dictionary );
-	for ( auto &it : value )
-		s += it.first.size() + it.second.mem_size();
+	// the keys are shared with every other dictionary
+	for ( size_t i = 0; i < _size; ++i )
+		s += sizeof( Name ) + entries()[i].second.mem_size();
 	return s;
 }
 
@@ -240,6 +359,23 @@ size_t Stream::mem_size() const
 	return sizeof( Stream ) + _dict.mem_size();
 }
 
+//! a new value, from the arena if there is one
+template <typename T, typename... ARGS>
+T *newValue( Arena *i_arena, bool i_shared, ARGS &&... i_args )
+{
+	T *v;
+	if ( i_arena == nullptr )
+		v = new T( std::forward<ARGS>( i_args )... );
+	else
+	{
+		v = new ( i_arena->allocate( sizeof( T ) ) )
+		    T( std::forward<ARGS>( i_args )... );
+		v->inArena = true;
+	}
+	v->shared = i_shared;
+	return v;
+}
+
 const int kBoolTag = 1;
 const int kIntTag = 2;
 const int kRealTag = 3;
@@ -252,6 +388,46 @@ using namespace details;
 
 Object kObjectNull;
 
+Arena *Object::arenaOf( Document *i_doc )
+{
+	return i_doc != nullptr ? i_doc->_arena.get() : nullptr;
+}
+
+bool Object::isSharedIn( Document *i_doc )
+{
+	return i_doc != nullptr and ( i_doc->_concurrent or i_doc->_preloading );
+}
+
+void Object::share() const
+{
+	std::vector<const Object *> stack( 1, this );
+	while ( not stack.empty() )
+	{
+		auto obj = stack.back();
+		stack.pop_back();
+		if ( not isPtr( obj->_storage.data ) )
+			continue;
+		auto value = obj->_storage.ptr;
+		value->shared = true;
+		switch ( value->type )
+		{
+			case Type::k_array:
+				for ( auto &it : obj->array_items() )
+					stack.push_back( &it );
+				break;
+			case Type::k_dictionary:
+				for ( auto &it : obj->dictionary_items() )
+					stack.push_back( &it.second );
+				break;
+			case Type::k_stream:
+				stack.push_back( &( (Stream *)value )->_dict );
+				break;
+			default:
+				break;
+		}
+	}
+}
+
 Object Object::create_number( float value )
 {
 	Object obj;
@@ -284,11 +460,17 @@ Object Object::create_name( const std::string_view &value )
 	}
 	else
 	{
-		obj._storage.ptr = StringStorage::alloc( Type::k_name, value );
+		// same storage as the dictionary keys
+		obj._storage.data = uint64_t( uintptr_t( Name::intern( value ) ) ) |
+		                    kNameAtomTag;
 	}
 	return obj;
 }
 Object Object::create_string( const std::string_view &value )
+{
+	return create_string( nullptr, value );
+}
+Object Object::create_string( Document *i_doc, const std::string_view &value )
 {
 	Object obj;
 	if ( value.size() < 7 and value.find( '\0' ) == std::string_view::npos )
@@ -299,32 +481,80 @@ Object Object::create_string( const std::string_view &value )
 	}
 	else
 	{
-		obj._storage.ptr = StringStorage::alloc( Type::k_string, value );
+		obj._storage.ptr =
+		    StringStorage::alloc( Type::k_string,
+		                          value,
+		                          arenaOf( i_doc ),
+		                          isSharedIn( i_doc ) );
 	}
 	return obj;
 }
+void Object::adopt( Arena *i_arena, const Object &i_obj )
+{
+	if ( isAtom( i_obj._storage.data ) or
+	     ( isPtr( i_obj._storage.data ) and not i_obj._storage.ptr->inArena ) )
+	{
+		// i_obj is never destroyed, its reference moves to the arena
+		Object ref;
+		ref._storage.data = i_obj._storage.data;
+		i_arena->keep( std::move( ref ) );
+	}
+}
+void Object::adopt( Arena *i_arena, const Name &i_key )
+{
+	if ( Name::counted( i_key._entry ) )
+	{
+		Name ref;
+		ref._entry = i_key._entry;
+		i_arena->keep( std::move( ref ) );
+	}
+}
+
 Object Object::create_array( Document *i_doc, const array &values )
 {
-	Object obj;
-	obj._storage.ptr = new Array( i_doc, values );
-	return obj;
+	return create_array( i_doc, array( values ) );
 }
 Object Object::create_array( Document *i_doc, array &&values )
 {
+	auto arena = arenaOf( i_doc );
+	auto arr =
+	    Array::alloc( i_doc, values.size(), arena, isSharedIn( i_doc ) );
+	auto items = arr->items();
+	for ( auto &it : values )
+	{
+		*items = std::move( it );
+		if ( arena != nullptr )
+			adopt( arena, *items );
+		++items;
+	}
 	Object obj;
-	obj._storage.ptr = new Array( i_doc, std::move( values ) );
+	obj._storage.ptr = arr;
 	return obj;
 }
 Object Object::create_dictionary( Document *i_doc, const dictionary &values )
 {
-	Object obj;
-	obj._storage.ptr = new Dictionary( i_doc, values );
-	return obj;
+	return create_dictionary( i_doc, dictionary( values ) );
 }
 Object Object::create_dictionary( Document *i_doc, dictionary &&values )
 {
+	auto arena = arenaOf( i_doc );
+	auto dict =
+	    Dictionary::alloc( i_doc, values.size(), arena, isSharedIn( i_doc ) );
+	// in key order
+	auto entries = dict->entries();
+	for ( auto &it : values )
+	{
+		entries->first = it.first;
+		entries->second = std::move( it.second );
+		if ( arena != nullptr )
+		{
+			adopt( arena, entries->first );
+			adopt( arena, entries->second );
+		}
+		++entries;
+	}
 	Object obj;
-	obj._storage.ptr = new Dictionary( i_doc, std::move( values ) );
+	obj._storage.ptr = dict;
 	return obj;
 }
 Object Object::create_ref( int i_ref, uint16_t i_gen )
@@ -339,7 +569,18 @@ Object Object::create_stream(
     Object &&i_dict, size_t p, size_t len, int i_id, uint16_t i_gen )
 {
 	Object obj;
-	obj._storage.ptr = new Stream( std::move( i_dict ), p, len, i_id, i_gen );
+	auto doc = i_dict.document();
+	auto arena = arenaOf( doc );
+	auto stream = newValue<Stream>( arena,
+	                                isSharedIn( doc ),
+	                                std::move( i_dict ),
+	                                p,
+	                                len,
+	                                i_id,
+	                                i_gen );
+	if ( arena != nullptr )
+		adopt( arena, stream->_dict );
+	obj._storage.ptr = stream;
 	return obj;
 }
 
@@ -347,6 +588,8 @@ Object::~Object()
 {
 	if ( isPtr( _storage.data ) )
 		_storage.ptr->dec();
+	else if ( isAtom( _storage.data ) )
+		Name::release( atomEntry( _storage.data ) );
 }
 
 Object::Object( const Object &rhs ) noexcept
@@ -354,6 +597,8 @@ Object::Object( const Object &rhs ) noexcept
 	_storage.data = rhs._storage.data;
 	if ( isPtr( _storage.data ) )
 		_storage.ptr->inc();
+	else if ( isAtom( _storage.data ) )
+		Name::retain( atomEntry( _storage.data ) );
 }
 Object &Object::operator=( const Object &rhs ) noexcept
 {
@@ -361,8 +606,12 @@ Object &Object::operator=( const Object &rhs ) noexcept
 	{
 		if ( isPtr( rhs._storage.data ) )
 			rhs._storage.ptr->inc();
+		else if ( isAtom( rhs._storage.data ) )
+			Name::retain( atomEntry( rhs._storage.data ) );
 		if ( isPtr( _storage.data ) )
 			_storage.ptr->dec();
+		else if ( isAtom( _storage.data ) )
+			Name::release( atomEntry( _storage.data ) );
 		_storage.data = rhs._storage.data;
 	}
 	return *this;
@@ -401,6 +650,7 @@ Object::Type Object::type() const
 		case kRefTag:
 			return Type::k_objectref;
 		case kNameTag:
+		case kNameAtomTag:
 			return Type::k_name;
 		case kStringTag:
 			return Type::k_string;
@@ -426,9 +676,7 @@ bool Object::is_number() const
 }
 bool Object::is_name() const
 {
-	if ( isPtr( _storage.data ) )
-		return _storage.ptr->type == Type::k_name;
-	return ( _storage.data & 0x7 ) == kNameTag;
+	return ( _storage.data & 0x7 ) == kNameTag or isAtom( _storage.data );
 }
 bool Object::is_string() const
 {
@@ -479,6 +727,8 @@ void Object::clear()
 {
 	if ( isPtr( _storage.data ) )
 		_storage.ptr->dec();
+	else if ( isAtom( _storage.data ) )
+		Name::release( atomEntry( _storage.data ) );
 	_storage.data = 0;
 }
 
@@ -518,11 +768,8 @@ bool Object::bool_value() const
 
 std::string Object::name_value() const
 {
-	if ( isPtr( _storage.data ) and _storage.ptr->type == Type::k_name )
-	{
-		return {( (StringStorage *)_storage.ptr )->buf,
-		        ( (StringStorage *)_storage.ptr )->len};
-	}
+	if ( isAtom( _storage.data ) )
+		return std::string( Name::view( atomEntry( _storage.data ) ) );
 	else if ( ( _storage.data & 0x7 ) == kNameTag )
 	{
 		return _storage.string.c;
@@ -555,11 +802,14 @@ std::string Object::string_uvalue() const
 	}
 	return {};
 }
-const Object::array &Object::array_items() const
+Object::array_range Object::array_items() const
 {
 	if ( is_array() )
-		return ( (Array *)_storage.ptr )->value;
-	return statics().empty_array;
+	{
+		auto arr = (Array *)_storage.ptr;
+		return {arr->items(), arr->_size};
+	}
+	return {};
 }
 Object::array Object::array_items_resolved() const
 {
@@ -567,25 +817,28 @@ Object::array Object::array_items_resolved() const
 	if ( is_array() )
 	{
 		auto arr = (Array *)_storage.ptr;
-		for ( auto &it : arr->value )
+		r.reserve( arr->_size );
+		for ( auto &it : array_items() )
 			r.push_back( arr->_doc->resolveIndirect( it ) );
 	}
 	return r;
 }
-const Object::dictionary &Object::dictionary_items() const
+Object::dictionary_range Object::dictionary_items() const
 {
 	switch ( type() )
 	{
 		case Type::k_dictionary:
-			return ( (Dictionary *)_storage.ptr )->value;
-			break;
+		{
+			auto dict = (Dictionary *)_storage.ptr;
+			return {dict->entries(), dict->_size};
+		}
 		case Type::k_stream:
 			return ( (Stream *)_storage.ptr )->_dict.dictionary_items();
 			break;
 		default:
 			break;
 	}
-	return statics().empty_dictionary;
+	return {};
 }
 Object::dictionary Object::dictionary_items_resolved() const
 {
@@ -595,8 +848,8 @@ Object::dictionary Object::dictionary_items_resolved() const
 		case Type::k_dictionary:
 		{
 			auto dict = (Dictionary *)_storage.ptr;
-			r.reserve( dict->value.size() );
-			for ( auto &it : dict->value )
+			r.reserve( dict->_size );
+			for ( auto &it : dictionary_items() )
 				r[it.first] = dict->_doc->resolveIndirect( it.second );
 			break;
 		}
@@ -654,7 +907,7 @@ size_t Object::array_size() const
 	if ( is_array() )
 	{
 		auto arr = (Array *)_storage.ptr;
-		return arr->value.size();
+		return arr->_size;
 	}
 	return 0;
 }
@@ -663,8 +916,8 @@ const Object &Object::operator[]( size_t i ) const
 	if ( is_array() )
 	{
 		auto arr = (Array *)_storage.ptr;
-		if ( i < arr->value.size() )
-			return arr->_doc->resolveIndirect( arr->value[i] );
+		if ( i < arr->_size )
+			return arr->_doc->resolveIndirect( arr->items()[i] );
 	}
 	return kObjectNull;
 }
@@ -673,7 +926,7 @@ size_t Object::dictionary_size() const
 	switch ( type() )
 	{
 		case Type::k_dictionary:
-			return ( (Dictionary *)_storage.ptr )->value.size();
+			return ( (Dictionary *)_storage.ptr )->_size;
 			break;
 		case Type::k_stream:
 			return ( (Stream *)_storage.ptr )->_dict.dictionary_size();
@@ -690,8 +943,50 @@ const Object &Object::operator[]( const std::string_view &key ) const
 		case Type::k_dictionary:
 		{
 			auto dict = (Dictionary *)_storage.ptr;
-			auto it = dict->value.find( key );
-			if ( it != dict->value.end() )
+			// a standard key has a known atom, no need to intern it
+			if ( dict->_size <= 16 )
+			{
+				if ( auto entry = Name::wellKnown( key ) )
+				{
+					for ( auto &it : dictionary_items() )
+					{
+						if ( it.first._entry == entry )
+							return dict->_doc->resolveIndirect( it.second );
+					}
+					break;
+				}
+			}
+			if ( auto it = dict->find( key ) )
+				return dict->_doc->resolveIndirect( it->second );
+			break;
+		}
+		case Type::k_stream:
+			return ( (Stream *)_storage.ptr )->_dict[key];
+			break;
+		default:
+			break;
+	}
+	return kObjectNull;
+}
+const Object &Object::operator[]( const Name &key ) const
+{
+	switch ( type() )
+	{
+		case Type::k_dictionary:
+		{
+			// most dictionaries are small, a scan comparing atoms beats the
+			// string compares of a binary search
+			auto dict = (Dictionary *)_storage.ptr;
+			if ( dict->_size <= 16 )
+			{
+				for ( auto &it : dictionary_items() )
+				{
+					if ( it.first == key )
+						return dict->_doc->resolveIndirect( it.second );
+				}
+				break;
+			}
+			if ( auto it = dict->find( key ) )
 				return dict->_doc->resolveIndirect( it->second );
 			break;
 		}
@@ -755,9 +1050,15 @@ bool Object::operator==( const Object &rhs ) const
 			case Type::k_string:
 				return string_value() == rhs.string_value();
 			case Type::k_array:
-				return array_items() == rhs.array_items();
+			{
+				auto l = array_items(), r = rhs.array_items();
+				return std::equal( l.begin(), l.end(), r.begin(), r.end() );
+			}
 			case Type::k_dictionary:
-				return dictionary_items() == rhs.dictionary_items();
+			{
+				auto l = dictionary_items(), r = rhs.dictionary_items();
+				return std::equal( l.begin(), l.end(), r.begin(), r.end() );
+			}
 			case Type::k_stream:
 			{
 				auto lhss = (Stream *)_storage.ptr;
@@ -829,9 +1130,17 @@ bool Object::operator<( const Object &rhs ) const
 			case Type::k_string:
 				return string_value() < rhs.string_value();
 			case Type::k_array:
-				return array_items() < rhs.array_items();
+			{
+				auto l = array_items(), r = rhs.array_items();
+				return std::lexicographical_compare(
+				    l.begin(), l.end(), r.begin(), r.end() );
+			}
 			case Type::k_dictionary:
-				return dictionary_items() < rhs.dictionary_items();
+			{
+				auto l = dictionary_items(), r = rhs.dictionary_items();
+				return std::lexicographical_compare(
+				    l.begin(), l.end(), r.begin(), r.end() );
+			}
 			case Type::k_stream:
 			{
 				auto lhss = (Stream *)_storage.ptr;
@@ -935,4 +1244,11 @@ size_t Object::mem_size() const
 	return sizeof( Object );
 }
 
+size_t Object::use_count() const
+{
+	if ( isPtr( _storage.data ) )
+		return _storage.ptr->refCount.load( std::memory_order_relaxed );
+	return 0;
+}
+
 }
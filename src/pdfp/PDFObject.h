@@ -11,18 +11,22 @@
 #define H_PDFP_PDFOBJECT
 
 #include "pdfp/PDFData.h"
+#include "pdfp/PDFName.h"
+#include "su/containers/array_view.h"
 #include "su/containers/flat_map.h"
 #include "su/base/platform.h"
 #include "su/base/endian.h"
 #include <vector>
 #include <string>
 #include <unordered_set>
+#include <utility>
 
 namespace pdfp {
 
 namespace details {
 struct ObjectValue;
 }
+class Arena;
 class Document;
 
 class Object final
@@ -47,7 +51,12 @@ public:
 
 	// Array, Dictionary and ref
 	using array = std::vector<Object>;
-	using dictionary = su::flat_map<std::string, Object, std::less<>>;
+	using dictionary = su::flat_map<Name, Object, NameLess>;
+	//! the items of an array or dictionary object, in place, valid as long
+	//! as the object is; the dictionary entries are in key order
+	using array_range = su::array_view<const Object>;
+	using dictionary_entry = std::pair<Name, Object>;
+	using dictionary_range = su::array_view<const dictionary_entry>;
 	struct ObjRef
 	{
 		int ref = -1;
@@ -78,6 +87,9 @@ public:
 	static Object create_boolean( bool value );
 	static Object create_name( const std::string_view &value );
 	static Object create_string( const std::string_view &value );
+	//! same, allocated in the document arena when it has one
+	static Object create_string( Document *i_doc,
+	                             const std::string_view &value );
 	static Object create_array( Document *i_doc, const array &values );
 	static Object create_array( Document *i_doc, array &&values );
 	static Object create_dictionary( Document *i_doc,
@@ -117,10 +129,10 @@ public:
 	std::string string_value() const;
 	std::string string_uvalue() const;
 
-	const array &array_items() const;
+	array_range array_items() const;
 	array array_items_resolved() const;
 
-	const dictionary &dictionary_items() const;
+	dictionary_range dictionary_items() const;
 	dictionary dictionary_items_resolved() const;
 
 	const Object &stream_dictionary() const;
@@ -135,6 +147,8 @@ public:
 	// otherwise.
 	size_t dictionary_size() const;
 	const Object &operator[]( const std::string_view &key ) const;
+	//! same, the keys are compared as atoms
+	const Object &operator[]( const Name &key ) const;
 
 	bool operator==( const Object &rhs ) const;
 	bool operator<( const Object &rhs ) const;
@@ -148,6 +162,9 @@ public:
 	void dump() const;
 	
 	size_t mem_size() const;
+	//! number of Objects sharing the value, 0 for a value stored in the
+	//! Object itself
+	size_t use_count() const;
 
 private:
 
@@ -221,7 +238,18 @@ private:
 	} _storage;
 	static Object create_stream(
 	    Object &&i_dict, size_t p, size_t len, int i_id, uint16_t i_gen );
-
+	static Arena *arenaOf( Document *i_doc );
+	//! the new values can be seen by several threads
+	static bool isSharedIn( Document *i_doc );
+	//! atomic reference counts for this value and the ones it contains,
+	//! before other threads can see them
+	void share() const;
+	//! i_obj is stored in the arena and will never be destroyed, what it
+	//! references outside of the arena is released with the arena instead
+	static void adopt( Arena *i_arena, const Object &i_obj );
+	static void adopt( Arena *i_arena, const Name &i_key );
+
+	friend class Document;
 	friend class Parser;
 };
 static_assert( sizeof( Object ) == sizeof( uint64_t ), "" );
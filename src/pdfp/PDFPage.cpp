@@ -8,70 +8,137 @@
  */
 
 #include "PDFPage.h"
+#include "PDFDocument.h"
 #include <string>
 
 namespace {
 
-pdfp::Rect extractRect( pdfp::Object i_dict, const std::string &i_key )
+pdfp::Rect extractRect( const pdfp::Object &i_obj )
 {
-	auto obj = i_dict[i_key];
-	while ( not i_dict.is_null() and obj.is_null() )
+	if ( i_obj.array_size() < 4 )
+		return {};
+	float v[4];
+	for ( size_t i = 0; i < 4; ++i )
 	{
-		i_dict = i_dict["Parent"];
-		obj = i_dict[i_key];
+		auto &n = i_obj[i];
+		if ( not n.is_number() )
+			return {};
+		v[i] = n.real_value();
 	}
-	auto arr = obj.array_items_resolved();
-	if ( arr.size() >= 4 and
-			arr[0].is_number() and
-			arr[1].is_number() and
-			arr[2].is_number() and
-			arr[3].is_number() )
-	{
-		auto a = arr[0].real_value();
-		auto b = arr[1].real_value();
-		auto c = arr[2].real_value();
-		auto d = arr[3].real_value();
-		return pdfp::Rect{a, b, c - a, d - b};
-	}
-	return {};
+	return pdfp::Rect{v[0], v[1], v[2] - v[0], v[3] - v[1]};
+}
+
+//! the inheritable keys, built on first use, after the name table
+struct Keys
+{
+	pdfp::Name mediaBox{ "MediaBox" };
+	pdfp::Name cropBox{ "CropBox" };
+	pdfp::Name bleedBox{ "BleedBox" };
+	pdfp::Name trimBox{ "TrimBox" };
+	pdfp::Name artBox{ "ArtBox" };
+	pdfp::Name rotate{ "Rotate" };
+	pdfp::Name resources{ "Resources" };
+};
+const Keys &keys()
+{
+	static const Keys k;
+	return k;
 }
 }
 
 namespace pdfp {
 
+void PageAttributes::merge( const Object &i_node )
+{
+	// the nearest box is final, even when it is not a valid rectangle
+	auto setRect = [&i_node]( const Name &i_key, Rect &o_rect ) {
+		auto &obj = i_node[i_key];
+		if ( not obj.is_null() )
+			o_rect = extractRect( obj );
+	};
+	setRect( keys().mediaBox, mediaBox );
+	setRect( keys().cropBox, cropBox );
+	setRect( keys().bleedBox, bleedBox );
+	setRect( keys().trimBox, trimBox );
+	setRect( keys().artBox, artBox );
+
+	auto &r = i_node[keys().rotate];
+	if ( r.is_number() )
+		rotate = r.int_value();
+	auto &res = i_node[keys().resources];
+	if ( res.is_dictionary() )
+		resources = res;
+}
+
+Page::Page( const Object &i_dict ) :
+    _dict( i_dict )
+{
+	auto doc = _dict.document();
+	if ( doc != nullptr )
+		_inherited = doc->inheritedAttributes( _dict );
+}
+
+Rect Page::box( const Name &i_key, Rect PageAttributes::*i_inherited ) const
+{
+	auto &obj = _dict[i_key];
+	if ( obj.is_null() and _inherited.get() != nullptr )
+		return ( *_inherited ).*i_inherited;
+	return extractRect( obj );
+}
+
 Rect Page::mediaBox() const
 {
-	return extractRect( _dict, "MediaBox" );
+	return box( keys().mediaBox, &PageAttributes::mediaBox );
 }
 
 Rect Page::cropBox() const
 {
-	return extractRect( _dict, "CropBox" );
+	return box( keys().cropBox, &PageAttributes::cropBox );
 }
 
 Rect Page::bleedBox() const
 {
-	return extractRect( _dict, "BleedBox" );
+	return box( keys().bleedBox, &PageAttributes::bleedBox );
 }
 
 Rect Page::trimBox() const
 {
-	return extractRect( _dict, "TrimBox" );
+	return box( keys().trimBox, &PageAttributes::trimBox );
 }
 
 Rect Page::artBox() const
 {
-	return extractRect( _dict, "ArtBox" );
+	return box( keys().artBox, &PageAttributes::artBox );
 }
 
 int Page::rotate() const
 {
-	return _dict["Rotate"].int_value();
+	auto &obj = _dict[keys().rotate];
+	if ( obj.is_number() or _inherited.get() == nullptr )
+		return obj.int_value();
+	return _inherited->rotate;
+}
+
+Object Page::resources() const
+{
+	auto &obj = _dict[keys().resources];
+	if ( obj.is_dictionary() or _inherited.get() == nullptr )
+		return obj;
+	return _inherited->resources;
+}
+
+float Page::userUnit() const
+{
+	// not inheritable
+	static const Name kUserUnit( "UserUnit" );
+	auto &obj = _dict[kUserUnit];
+	return obj.is_number() ? obj.real_value() : 1.0f;
 }
 
 Object Page::contents() const
 {
-	return _dict["Contents"];
+	static const Name kContents( "Contents" );
+	return _dict[kContents];
 }
 
 }
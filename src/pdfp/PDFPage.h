@@ -11,6 +11,7 @@
 #define H_PDFP_PDFPAGGE
 
 #include "PDFObject.h"
+#include <memory>
 
 namespace pdfp {
 
@@ -29,12 +30,40 @@ struct Rect
 	}
 };
 
+/*!
+   @brief the attributes a page tree node passes to its kids.
+
+       Resolved once per node and shared by every page under it, a page
+   entry overrides them.
+*/
+struct PageAttributes
+{
+	Rect mediaBox;
+	Rect cropBox;
+	Rect bleedBox;
+	Rect trimBox;
+	Rect artBox;
+	int rotate{ 0 };
+	Object resources;
+
+	//! override with the entries of i_node
+	void merge( const Object &i_node );
+};
+
 class Page final
 {
 public:
 	Page() = default;
 	
-	Page( const Object &i_dict ) : _dict( i_dict ) {}
+	//! a page dictionary, the inherited attributes are looked up in its
+	//! document
+	Page( const Object &i_dict );
+	Page( const Object &i_dict,
+	      std::shared_ptr<const PageAttributes> i_inherited ) :
+	    _dict( i_dict ),
+	    _inherited( std::move( i_inherited ) )
+	{
+	}
 	~Page() = default;
 
 	bool is_null() const { return _dict.is_null(); }
@@ -45,6 +74,8 @@ public:
 	Rect trimBox() const;
 	Rect artBox() const;
 	int rotate() const;
+	Object resources() const;
+	float userUnit() const;
 	Object contents() const;
 	Object dictionary() const { return _dict; }
 
@@ -52,6 +83,10 @@ public:
 
 private:
 	Object _dict;
+	//! from the parent nodes, null for a page without parent
+	std::shared_ptr<const PageAttributes> _inherited;
+
+	Rect box( const Name &i_key, Rect PageAttributes::*i_inherited ) const;
 };
 }
 
@@ -0,0 +1,45 @@
+/*
+ *  PDFReader.h
+ *  pdfp
+ *
+ *  Created by Sandy Martel on 2026-10-17.
+ *  Copyright 2026 Sandy Martel. All rights reserved.
+ *
+ */
+
+#ifndef H_PDFP_PDFREADER
+#define H_PDFP_PDFREADER
+
+#include "su/containers/array_view.h"
+#include <ios>
+
+namespace pdfp {
+
+/*!
+ @brief Abstract interface to the bytes of a PDF file.
+
+    random access, a read never depends on a previous one and read() may be
+    called from several threads at the same time.
+*/
+class RandomAccessReader
+{
+public:
+	RandomAccessReader( const RandomAccessReader & ) = delete;
+	RandomAccessReader &operator=( const RandomAccessReader & ) = delete;
+
+	virtual ~RandomAccessReader() = default;
+
+	//! total size in bytes
+	virtual size_t size() const = 0;
+
+	//! read up to o_buffer.size() bytes at i_pos, return the number of bytes
+	//! read, 0 or less at the end or on error
+	virtual std::streamoff read( size_t i_pos,
+	                             su::array_view<uint8_t> o_buffer ) const = 0;
+
+protected:
+	RandomAccessReader() = default;
+};
+}
+
+#endif
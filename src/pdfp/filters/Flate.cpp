@@ -10,6 +10,11 @@
 #include "Flate.h"
 #include "su/log/logger.h"
 #include <cassert>
+#include <climits>
+#include <vector>
+#if PDFP_USE_LIBDEFLATE
+#	include <libdeflate.h>
+#endif
 
 namespace {
 
@@ -39,75 +44,196 @@ void logZLibError( int err )
 			break;
 	}
 }
+
+void checkHeader( int c1, int c2 )
+{
+	if ( ( c1 & 0x0f ) != 0x08 )
+		log_error() << "wrong compression method";
+	if ( ( ( ( c1 << 8 ) + c2 ) % 31 ) != 0 )
+		log_error() << "bad FCHECK";
+	if ( c2 & 0x20 )
+		log_error() << "FDICT bit set";
+}
+
+//! deflate cannot do better, caps a bogus expected size
+const size_t kMaxRatio = 1032;
 }
 
 namespace pdfp {
 
-FlateDecode::~FlateDecode()
+struct InflateState
 {
-	if ( _inited )
+	z_stream zstream;
+	uint8_t inputBuffer[kFlateWindowSize];
+	int err;
+
+	InflateState()
 	{
-		int err = inflateEnd( &_zstream );
-		if ( err < 0 )
+		memset( &zstream, 0, sizeof( z_stream ) );
+		err = inflateInit2( &zstream, -kMaxWBits );
+		if ( err != Z_OK )
 			logZLibError( err );
 	}
+	~InflateState()
+	{
+		if ( err == Z_OK )
+			inflateEnd( &zstream );
+	}
+};
+
+namespace {
+
+//! states kept per thread, several streams can be read at once
+const size_t kMaxPooledStates = 4;
+
+struct InflateStatePool
+{
+	std::vector<std::unique_ptr<InflateState>> states;
+#if PDFP_USE_LIBDEFLATE
+	//! one is enough, decodeAll() does not keep it
+	libdeflate_decompressor *decompressor = nullptr;
+#endif
+	~InflateStatePool();
+};
+//! trivial, still valid while the pool is destroyed at thread exit
+thread_local bool tPoolDestroyed = false;
+thread_local InflateStatePool tPool;
+
+InflateStatePool::~InflateStatePool()
+{
+	tPoolDestroyed = true;
+#if PDFP_USE_LIBDEFLATE
+	if ( decompressor != nullptr )
+		libdeflate_free_decompressor( decompressor );
+#endif
 }
 
-void FlateDecode::rewind()
+#if PDFP_USE_LIBDEFLATE
+//! all or nothing: false for a damaged stream, that zlib decodes up to the
+//! error
+bool decodeAllLibdeflate( const uint8_t *i_ptr,
+                          size_t i_len,
+                          size_t i_capacity,
+                          pdfp::Data &o_data )
 {
-	rewindNext();
-	if ( _inited )
+	if ( tPoolDestroyed )
+		return false;
+	if ( tPool.decompressor == nullptr )
 	{
-		int err = inflateEnd( &_zstream );
-		if ( err < 0 )
-			logZLibError( err );
-		_inited = false;
+		tPool.decompressor = libdeflate_alloc_decompressor();
+		if ( tPool.decompressor == nullptr )
+			return false;
+	}
+	for ( ;; )
+	{
+		auto buffer = std::make_unique<uint8_t[]>( i_capacity );
+		size_t actual = 0;
+		auto r = libdeflate_deflate_decompress_ex( tPool.decompressor,
+		                                           i_ptr,
+		                                           i_len,
+		                                           buffer.get(),
+		                                           i_capacity,
+		                                           nullptr,
+		                                           &actual );
+		if ( r == LIBDEFLATE_SUCCESS )
+		{
+			o_data.buffer = std::move( buffer );
+			o_data.length = actual;
+			return true;
+		}
+		if ( r != LIBDEFLATE_INSUFFICIENT_SPACE or
+		     i_capacity >= i_len * kMaxRatio )
+			return false;
+		i_capacity *= 2;
+	}
+}
+#endif
+}
+
+void InflateStateRelease::operator()( InflateState *i_state ) const
+{
+	std::unique_ptr<InflateState> state( i_state );
+	if ( tPoolDestroyed or tPool.states.size() >= kMaxPooledStates )
+		return;
+	int err = inflateReset( &state->zstream );
+	if ( err != Z_OK )
+	{
+		logZLibError( err );
+		return;
+	}
+	state->zstream.next_in = nullptr;
+	state->zstream.avail_in = 0;
+	tPool.states.push_back( std::move( state ) );
+}
+
+InflateStatePtr FlateDecode::acquireState()
+{
+	if ( not tPoolDestroyed and not tPool.states.empty() )
+	{
+		InflateStatePtr state( tPool.states.back().release() );
+		tPool.states.pop_back();
+		return state;
 	}
+	InflateStatePtr state( new InflateState );
+	if ( state->err != Z_OK )
+		return {};
+	return state;
+}
+
+void FlateDecode::rewind()
+{
+	rewindNext();
+	_state.reset();
 }
 
 std::streamoff FlateDecode::read( su::array_view<uint8_t> o_buffer )
 {
 	int err;
-	if ( not _inited )
+	if ( _state.get() == nullptr )
 	{
-		memset( &_zstream, 0, sizeof( z_stream ) );
-		err = inflateInit2( &_zstream, -kMaxWBits );
-		assert( err == Z_OK );
+		_state = acquireState();
+		if ( _state.get() == nullptr )
+			return EOF;
 		_adler32 = adler32( 0L, Z_NULL, 0 );
 
-		_inited = true;
-
-		// read the header
-		int c1;
-		do
+		// the header, after optional white space, from the first input block
+		auto &zstream = _state->zstream;
+		int header[2];
+		int n = 0;
+		while ( n < 2 )
 		{
-			c1 = getByteNext();
-		} while ( c1 != EOF and isspace( c1 ) );
-		int c2 = getByteNext();
-		if ( c1 == EOF or c2 == EOF )
-			return EOF;
-		if ( ( c1 & 0x0f ) != 0x08 )
-			log_error() << "wrong compression method";
-		if ( ( ( ( c1 << 8 ) + c2 ) % 31 ) != 0 )
-			log_error() << "bad FCHECK";
-		if ( c2 & 0x20 )
-			log_error() << "FDICT bit set";
+			if ( zstream.avail_in == 0 )
+			{
+				auto len =
+				    readNext( {_state->inputBuffer, kFlateWindowSize} );
+				if ( len <= 0 )
+					return EOF;
+				zstream.next_in = _state->inputBuffer;
+				zstream.avail_in = (uInt)len;
+			}
+			int c = *zstream.next_in++;
+			--zstream.avail_in;
+			if ( n > 0 or not isspace( c ) )
+				header[n++] = c;
+		}
+		checkHeader( header[0], header[1] );
 	}
 
-	_zstream.next_out = o_buffer.data();
-	_zstream.avail_out = (uInt)o_buffer.size();
-	while ( _zstream.avail_out > 0 )
+	auto &zstream = _state->zstream;
+	zstream.next_out = o_buffer.data();
+	zstream.avail_out = (uInt)o_buffer.size();
+	while ( zstream.avail_out > 0 )
 	{
-		if ( _zstream.avail_in == 0 )
+		if ( zstream.avail_in == 0 )
 		{
-			auto len = readNext( {_inputBuffer, kFlateWindowSize} );
+			auto len = readNext( {_state->inputBuffer, kFlateWindowSize} );
 			if ( len <= 0 )
 				break;
-			_zstream.next_in = _inputBuffer;
-			_zstream.avail_in = (uInt)len;
+			zstream.next_in = _state->inputBuffer;
+			zstream.avail_in = (uInt)len;
 		}
 
-		err = inflate( &_zstream, Z_NO_FLUSH );
+		err = inflate( &zstream, Z_NO_FLUSH );
 		if ( err < 0 )
 		{
 			logZLibError( err );
@@ -116,16 +242,100 @@ std::streamoff FlateDecode::read( su::array_view<uint8_t> o_buffer )
 		else if ( err == Z_STREAM_END )
 		{
 			// read the 4 bytes trailer
-			if ( _zstream.avail_in < 4 )
-				readNext( {_inputBuffer, 4 - _zstream.avail_in} );
+			if ( zstream.avail_in < 4 )
+				readNext( {_state->inputBuffer, 4 - zstream.avail_in} );
 			break;
 		}
 		else
 		{
-			//_adler32 = adler32( _adler32, _zstream.next_out, len );
+			//_adler32 = adler32( _adler32, zstream.next_out, len );
 		}
 	}
-	size_t s = o_buffer.size() - _zstream.avail_out;
+	size_t s = o_buffer.size() - zstream.avail_out;
 	return s == 0 ? EOF : s;
 }
+
+void FlateDecode::decodeAll( su::array_view<const uint8_t> i_input,
+                             size_t i_sizeHint,
+                             size_t i_limit,
+                             Data &o_data )
+{
+	auto ptr = i_input.data();
+	auto end = ptr + i_input.size();
+	while ( ptr < end and isspace( *ptr ) )
+		++ptr;
+	if ( end - ptr < 2 )
+		return;
+	checkHeader( ptr[0], ptr[1] );
+	ptr += 2;
+
+	size_t inputSize = end - ptr;
+	size_t capacity = i_limit > 0 ? i_limit : i_sizeHint;
+	if ( capacity == 0 )
+		capacity = inputSize * 4;
+	capacity = std::max<size_t>(
+	    std::min<size_t>( capacity, inputSize * kMaxRatio ), 1024 );
+	if ( i_limit > 0 )
+		capacity = std::min( capacity, i_limit );
+
+#if PDFP_USE_LIBDEFLATE
+	// it cannot stop at a limit, zlib can
+	if ( i_limit == 0 and
+	     decodeAllLibdeflate( ptr, inputSize, capacity, o_data ) )
+		return;
+#endif
+
+	auto state = acquireState();
+	if ( state.get() == nullptr )
+		return;
+	auto &zstream = state->zstream;
+	int err;
+
+	auto buffer = std::make_unique<uint8_t[]>( capacity );
+	size_t length = 0;
+	for ( ;; )
+	{
+		if ( zstream.avail_in == 0 )
+		{
+			if ( ptr == end )
+				break;
+			auto len = std::min<size_t>( end - ptr, UINT_MAX );
+			zstream.next_in = (Bytef *)ptr;
+			zstream.avail_in = (uInt)len;
+			ptr += len;
+		}
+		if ( length == capacity )
+		{
+			if ( i_limit > 0 and length >= i_limit )
+				break;
+			auto newCapacity = capacity * 2;
+			if ( i_limit > 0 )
+				newCapacity = std::min( newCapacity, i_limit );
+			auto newBuffer = std::make_unique<uint8_t[]>( newCapacity );
+			memcpy( newBuffer.get(), buffer.get(), length );
+			buffer = std::move( newBuffer );
+			capacity = newCapacity;
+		}
+
+		zstream.next_out = buffer.get() + length;
+		zstream.avail_out = (uInt)std::min<size_t>( capacity - length, UINT_MAX );
+		auto before = zstream.avail_out;
+		err = inflate( &zstream, Z_NO_FLUSH );
+		length += before - zstream.avail_out;
+		if ( err == Z_STREAM_END )
+			break;
+		if ( err < 0 and err != Z_BUF_ERROR )
+		{
+			logZLibError( err );
+			break;
+		}
+	}
+	state.reset();
+
+	if ( length > 0 )
+	{
+		o_data.buffer = std::move( buffer );
+		o_data.length = length;
+	}
+}
 }
@@ -11,6 +11,8 @@
 #define H_PDFP_FLATE
 
 #include "Filter.h"
+#include "pdfp/PDFData.h"
+#include <memory>
 #include <zlib.h>
 
 namespace pdfp {
@@ -18,19 +20,48 @@ namespace pdfp {
 const int kMaxWBits = 15;
 const int kFlateWindowSize = ( 1 << ( kMaxWBits ) );
 
+//! an initialized inflate state and its input buffer
+struct InflateState;
+//! give the state back to the pool of its thread
+struct InflateStateRelease
+{
+	void operator()( InflateState *i_state ) const;
+};
+using InflateStatePtr = std::unique_ptr<InflateState, InflateStateRelease>;
+
 class FlateDecode : public InputFilter
 {
 public:
 	FlateDecode() = default;
-	virtual ~FlateDecode();
+	virtual ~FlateDecode() = default;
 
 	virtual void rewind();
 	virtual std::streamoff read( su::array_view<uint8_t> o_buffer );
 
+	/*!
+	   @brief decode a whole stream already in memory.
+
+	       The output is allocated once from the expected size and inflated
+	   into directly. Same result as successive read().
+	   @param i_sizeHint the expected decoded size, 0 if unknown
+	   @param i_limit stop after that many bytes, 0 for no limit
+	*/
+	static void decodeAll( su::array_view<const uint8_t> i_input,
+	                       size_t i_sizeHint,
+	                       size_t i_limit,
+	                       Data &o_data );
+
+	/*!
+	   @brief an inflate state ready for a new stream.
+
+	       Taken from a per thread pool, reset when released instead of
+	   being freed, null if zlib fails.
+	*/
+	static InflateStatePtr acquireState();
+
 private:
-	uint8_t _inputBuffer[kFlateWindowSize];
-	z_stream _zstream;
-	bool _inited = false;
+	//! null until the first read
+	InflateStatePtr _state;
 	uLong _adler32;
 };
 }
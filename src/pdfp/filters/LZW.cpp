@@ -8,11 +8,14 @@
  */
 
 #include "LZW.h"
-#include <iostream>
+#include <algorithm>
+#include <cstring>
 
 namespace {
 const int CLEARTABLE = 256;
 const int EOD = 257;
+const int FIRSTCODE = 258;
+const int TABLESIZE = 4096;
 }
 
 namespace pdfp {
@@ -20,155 +23,117 @@ namespace pdfp {
 LZWDecode::LZWDecode( int i_EarlyChange ) :
     _EarlyChange( i_EarlyChange )
 {
-	_dico.reserve( 4097 );
+	for ( int i = 0; i < 256; ++i )
+		_dico[i] = LZWDicoEntry{0, 1, uint8_t( i ), uint8_t( i )};
+	clearTable();
 }
 
 void LZWDecode::rewind()
 {
 	rewindNext();
-	_currentBytes = 0;
+	_currentBits = 0;
 	_goodBits = 0;
-	_pos = 0;
 	_endOfFile = false;
-	_codeLength = 9;
-	_first = true;
+	_pendingPos = _pendingSize = 0;
+	clearTable();
 }
 
 std::streamoff LZWDecode::read( su::array_view<uint8_t> o_buffer )
 {
-	if ( _endOfFile )
-		return EOF;
-
 	size_t s = 0;
-	while ( s < o_buffer.size() )
+	if ( _pendingPos < _pendingSize )
 	{
-		if ( _pos >= _buffer.size() and not fillBuffer() )
-			return s == 0 ? EOF : s;
-
-		size_t l =
-		    std::min( _buffer.size() - _pos, size_t( o_buffer.size() - s ) );
-		std::copy( _buffer.begin() + _pos,
-		           _buffer.begin() + _pos + l,
-		           o_buffer.begin() + s );
-
-		s += l;
-		_pos += l;
+		s = std::min( _pendingSize - _pendingPos, o_buffer.size() );
+		memcpy( o_buffer.data(), _pending + _pendingPos, s );
+		_pendingPos += s;
 	}
-	return s;
+	while ( s < o_buffer.size() and not _endOfFile )
+	{
+		if ( not decodeCode( o_buffer.data(), o_buffer.size(), s ) )
+			_endOfFile = true;
+	}
+	return s == 0 ? EOF : s;
 }
 
-bool LZWDecode::fillBuffer()
+bool LZWDecode::decodeCode( uint8_t *o_buffer, size_t i_size, size_t &io_pos )
 {
-	_pos = 0;
+	int code;
+	while ( ( code = readCode() ) == CLEARTABLE )
+		clearTable();
+	if ( code == EOF or code == EOD )
+		return false;
 
-	bool done;
-	do
-	{
-		done = true;
-		int code = readCode();
-		if ( code == EOF or code == EOD )
-		{
-			_buffer.clear();
-			_endOfFile = true;
-			return false;
-		}
-		else if ( code == CLEARTABLE )
-		{
-			clearTable();
-			done = false;
-		}
-		else
-		{
-			if ( _dico.size() >= 4097 )
-				clearTable();
+	// code == _nextCode is the previous string followed by its first byte
+	if ( code >= _nextCode and not( code == _nextCode and _prevCode >= 0 ) )
+		return false; // invalid, stop there
 
-			if ( code < 256 )
-			{
-				_buffer.clear();
-				_buffer.push_back( code );
-			}
-			else if ( (size_t)code < ( _dico.size() + 258 ) )
-			{
-				_buffer.clear();
-				int i;
-				for ( i = code; i > 255; )
-				{
-					_buffer.push_front( _dico[i - 258].tail );
-					i = _dico[i - 258].head;
-				}
-				_buffer.push_front( i );
-			}
-			else if ( (size_t)code == ( _dico.size() + 258 ) )
-			{
-				_buffer.push_back( _newChar );
-			}
-			else
-				break;
+	if ( _prevCode >= 0 and _nextCode < TABLESIZE )
+	{
+		auto &prev = _dico[_prevCode];
+		_dico[_nextCode] = LZWDicoEntry{uint16_t( _prevCode ),
+		                                uint16_t( prev.length + 1 ),
+		                                prev.first,
+		                                code == _nextCode ? prev.first
+		                                                  : _dico[code].first};
+		++_nextCode;
+		if ( _nextCode + _EarlyChange >= 2048 )
+			_codeLength = 12;
+		else if ( _nextCode + _EarlyChange >= 1024 )
+			_codeLength = 11;
+		else if ( _nextCode + _EarlyChange >= 512 )
+			_codeLength = 10;
+	}
+	_prevCode = code;
+
+	// write the string straight in the caller buffer when it fits
+	size_t length = _dico[code].length;
+	bool fits = io_pos + length <= i_size;
+	uint8_t *ptr = ( fits ? o_buffer + io_pos : _pending ) + length;
+	int c = code;
+	while ( c >= FIRSTCODE )
+	{
+		*--ptr = _dico[c].last;
+		c = _dico[c].prefix;
+	}
+	*--ptr = uint8_t( c );
 
-			_newChar = _buffer[0];
-			if ( _first )
-			{
-				_first = false;
-			}
-			else
-			{
-				_dico.push_back( LZWDicoEntry{_prevCode, _newChar} );
-				if ( ( ( _dico.size() + 258 ) + _EarlyChange ) == 512 )
-					_codeLength = 10;
-				else if ( ( ( _dico.size() + 258 ) + _EarlyChange ) == 1024 )
-					_codeLength = 11;
-				else if ( ( ( _dico.size() + 258 ) + _EarlyChange ) == 2048 )
-					_codeLength = 12;
-			}
-			_prevCode = code;
-		}
-	} while ( not done );
-	return not _buffer.empty();
+	if ( fits )
+		io_pos += length;
+	else
+	{
+		// the rest is for the next read
+		_pendingPos = i_size - io_pos;
+		_pendingSize = length;
+		memcpy( o_buffer + io_pos, _pending, _pendingPos );
+		io_pos = i_size;
+	}
+	return true;
 }
 
 int LZWDecode::readCode()
 {
-	int code = 0;
-	for ( int i = 0; i < _codeLength; ++i )
+	if ( _goodBits < _codeLength )
 	{
-		int bit = readBit();
-		if ( bit == EOF )
+		// whole bytes, as many as fit
+		while ( _goodBits <= 56 )
+		{
+			int c = getByteNext();
+			if ( c == EOF )
+				break;
+			_currentBits = ( _currentBits << 8 ) | uint8_t( c );
+			_goodBits += 8;
+		}
+		if ( _goodBits < _codeLength )
 			return EOF;
-		code = ( code << 1 ) | bit;
 	}
-	return code;
+	_goodBits -= _codeLength;
+	return int( _currentBits >> _goodBits ) & ( ( 1 << _codeLength ) - 1 );
 }
 
 void LZWDecode::clearTable()
 {
-	_first = true;
-	_dico.clear();
+	_nextCode = FIRSTCODE;
 	_codeLength = 9;
-}
-
-int LZWDecode::readBit()
-{
-	if ( _goodBits == 0 )
-	{
-		fillup();
-		if ( _goodBits == 0 )
-			return EOF;
-	}
-	int v = ( _currentBytes & ( 0x80000000 ) ) ? 1 : 0;
-	--_goodBits;
-	_currentBytes <<= 1;
-	return v;
-}
-
-void LZWDecode::fillup()
-{
-	while ( ( 32 - _goodBits ) >= 8 )
-	{
-		int c = getByteNext();
-		if ( c == EOF )
-			return;
-		_currentBytes |= ( c << ( 24 - _goodBits ) );
-		_goodBits += 8;
-	}
+	_prevCode = -1;
 }
 }
@@ -11,8 +11,6 @@
 #define H_PDFP_LZW
 
 #include "Filter.h"
-#include <deque>
-#include <vector>
 
 namespace pdfp {
 
@@ -26,34 +24,38 @@ public:
 	virtual std::streamoff read( su::array_view<uint8_t> o_buffer );
 
 private:
-	// bit reader
-	uint32_t _currentBytes = 0;
+	// bit reader, the next code is in the low _goodBits bits
+	uint64_t _currentBits = 0;
 	int _goodBits = 0;
 
-	int readBit();
-	void fillup();
-	void consumeCode( int i_codeLength, uint32_t i_code );
+	int readCode();
 
 	// Filter parameters
 	int _EarlyChange;
 
-	std::deque<uint8_t> _buffer;
-	size_t _pos = 0;
 	bool _endOfFile = false;
 
 	// decoding
+	//! a string is its prefix string followed by one byte, it is written
+	//! backward from its end following the prefixes
 	struct LZWDicoEntry
 	{
-		int head, tail;
+		uint16_t prefix;
+		uint16_t length;
+		uint8_t first, last;
 	};
-	std::vector<LZWDicoEntry> _dico;
-	int _codeLength = 9;
-	int _newChar, _prevCode;
-	bool _first = true;
+	LZWDicoEntry _dico[4096];
+	int _nextCode;
+	int _codeLength;
+	int _prevCode;
+
+	//! the rest of a string that did not fit in the caller buffer
+	uint8_t _pending[4096];
+	size_t _pendingPos = 0, _pendingSize = 0;
 
 	void clearTable();
-	bool fillBuffer();
-	int readCode();
+	//! false at the end of the data
+	bool decodeCode( uint8_t *o_buffer, size_t i_size, size_t &io_pos );
 };
 }
 
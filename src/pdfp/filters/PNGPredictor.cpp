@@ -10,25 +10,229 @@
 #include "PNGPredictor.h"
 #include <cassert>
 #include <cstdlib>
-#include <iostream>
+#include <cstring>
+
+#if defined( __SSE2__ ) or defined( _M_X64 ) or \
+    ( defined( _M_IX86_FP ) and _M_IX86_FP >= 2 )
+#	define PDFP_PNG_SSE2 1
+#	include <emmintrin.h>
+#endif
 
 namespace {
 
+//! read about that much from the next filter at once
+const size_t kBatchSize = 64 * 1024;
+
 inline uint8_t PaethPredictor( int a, int b, int c )
 {
 	// a = left, b = above, c = upper left
-	int p = a + b - c; // initial estimate
-	int pa = std::abs( p - a ); // distances to a, b, c
-	int pb = std::abs( p - b );
-	int pc = std::abs( p - c );
+	// distances to a, b, c of the initial estimate a + b - c
+	int pa = std::abs( b - c );
+	int pb = std::abs( a - c );
+	int pc = std::abs( a + b - c - c );
 	// return nearest of a,b,c,
 	// breaking ties in order a,b,c.
-	if ( pa <= pb and pa <= pc )
-		return a;
-	else if ( pb <= pc )
-		return b;
-	else
-		return c;
+	if ( pb < pa )
+	{
+		pa = pb;
+		a = b;
+	}
+	return pc < pa ? c : a;
+}
+
+#if PDFP_PNG_SSE2
+// one pixel of BPP bytes in the low bytes of a register
+template <int BPP>
+inline __m128i loadPixel( const uint8_t *i_ptr )
+{
+	uint64_t v = 0;
+	memcpy( &v, i_ptr, BPP );
+	return _mm_loadl_epi64( (const __m128i *)&v );
+}
+template <int BPP>
+inline void storePixel( uint8_t *o_ptr, __m128i i_pixel )
+{
+	uint64_t v;
+	_mm_storel_epi64( (__m128i *)&v, i_pixel );
+	memcpy( o_ptr, &v, BPP );
+}
+#endif
+
+// The row kernels decode in place, BPP is 0 when only known at run time.
+// Sub, Average and Paeth depend on the pixel to the left, the SIMD versions
+// work a pixel at a time, on all its bytes at once.
+
+template <int BPP>
+void decodeSub( uint8_t *io_row, size_t i_len, size_t i_bpp )
+{
+	const size_t bpp = BPP > 0 ? BPP : i_bpp;
+	size_t i = bpp;
+#if PDFP_PNG_SSE2
+	if ( BPP >= 3 and i_len >= bpp )
+	{
+		auto a = loadPixel<BPP>( io_row );
+		for ( ; i + bpp <= i_len; i += bpp )
+		{
+			a = _mm_add_epi8( a, loadPixel<BPP>( io_row + i ) );
+			storePixel<BPP>( io_row + i, a );
+		}
+	}
+#endif
+	for ( ; i < i_len; ++i )
+		io_row[i] += io_row[i - bpp];
+}
+
+void decodeUp( uint8_t *io_row, const uint8_t *i_prev, size_t i_len )
+{
+	size_t i = 0;
+#if PDFP_PNG_SSE2
+	for ( ; i + 16 <= i_len; i += 16 )
+	{
+		auto x = _mm_loadu_si128( (const __m128i *)( io_row + i ) );
+		auto b = _mm_loadu_si128( (const __m128i *)( i_prev + i ) );
+		_mm_storeu_si128( (__m128i *)( io_row + i ), _mm_add_epi8( x, b ) );
+	}
+#endif
+	for ( ; i < i_len; ++i )
+		io_row[i] += i_prev[i];
+}
+
+template <int BPP>
+void decodeAverage( uint8_t *io_row,
+                    const uint8_t *i_prev,
+                    size_t i_len,
+                    size_t i_bpp )
+{
+	const size_t bpp = BPP > 0 ? BPP : i_bpp;
+	size_t i = 0;
+	for ( ; i < bpp and i < i_len; ++i )
+		io_row[i] += i_prev[i] >> 1;
+#if PDFP_PNG_SSE2
+	if ( BPP >= 3 and i_len >= bpp )
+	{
+		// floor( ( a + b ) / 2 ) is the rounded up average minus the
+		// lost bit
+		const auto one = _mm_set1_epi8( 1 );
+		auto a = loadPixel<BPP>( io_row + i - bpp );
+		for ( ; i + bpp <= i_len; i += bpp )
+		{
+			auto b = loadPixel<BPP>( i_prev + i );
+			auto avg = _mm_sub_epi8( _mm_avg_epu8( a, b ),
+			                         _mm_and_si128( _mm_xor_si128( a, b ), one ) );
+			a = _mm_add_epi8( loadPixel<BPP>( io_row + i ), avg );
+			storePixel<BPP>( io_row + i, a );
+		}
+	}
+#endif
+	for ( ; i < i_len; ++i )
+		io_row[i] += ( int( i_prev[i] ) + int( io_row[i - bpp] ) ) >> 1;
+}
+
+template <int BPP>
+void decodePaeth( uint8_t *io_row,
+                  const uint8_t *i_prev,
+                  size_t i_len,
+                  size_t i_bpp )
+{
+	const size_t bpp = BPP > 0 ? BPP : i_bpp;
+	size_t i = 0;
+	// no left pixel: the predictor is the one above
+	for ( ; i < bpp and i < i_len; ++i )
+		io_row[i] += i_prev[i];
+#if PDFP_PNG_SSE2
+	if ( BPP >= 3 and i_len >= bpp )
+	{
+		// on 16 bits lanes
+		const auto zero = _mm_setzero_si128();
+		auto abs16 = [zero]( __m128i x ) {
+			return _mm_max_epi16( x, _mm_sub_epi16( zero, x ) );
+		};
+		auto a = _mm_unpacklo_epi8( loadPixel<BPP>( io_row + i - bpp ), zero );
+		auto c = _mm_unpacklo_epi8( loadPixel<BPP>( i_prev + i - bpp ), zero );
+		for ( ; i + bpp <= i_len; i += bpp )
+		{
+			auto b = _mm_unpacklo_epi8( loadPixel<BPP>( i_prev + i ), zero );
+			auto pa = _mm_sub_epi16( b, c );
+			auto pb = _mm_sub_epi16( a, c );
+			auto pc = abs16( _mm_add_epi16( pa, pb ) );
+			pa = abs16( pa );
+			pb = abs16( pb );
+			auto smallest = _mm_min_epi16( pc, _mm_min_epi16( pa, pb ) );
+			// ties favor a, then b
+			auto isA = _mm_cmpeq_epi16( smallest, pa );
+			auto isB = _mm_cmpeq_epi16( smallest, pb );
+			auto bOrC = _mm_or_si128( _mm_and_si128( isB, b ),
+			                          _mm_andnot_si128( isB, c ) );
+			auto nearest = _mm_or_si128( _mm_and_si128( isA, a ),
+			                             _mm_andnot_si128( isA, bOrC ) );
+			auto x = _mm_add_epi8( loadPixel<BPP>( io_row + i ),
+			                       _mm_packus_epi16( nearest, zero ) );
+			storePixel<BPP>( io_row + i, x );
+			a = _mm_unpacklo_epi8( x, zero );
+			c = b;
+		}
+	}
+#endif
+	for ( ; i < i_len; ++i )
+		io_row[i] += PaethPredictor( io_row[i - bpp], i_prev[i], i_prev[i - bpp] );
+}
+
+template <int BPP>
+void decodeRow( int i_predictor,
+                uint8_t *io_row,
+                const uint8_t *i_prev,
+                size_t i_len,
+                size_t i_bpp )
+{
+	switch ( i_predictor )
+	{
+		case 1:
+			decodeSub<BPP>( io_row, i_len, i_bpp );
+			break;
+		case 2:
+			decodeUp( io_row, i_prev, i_len );
+			break;
+		case 3:
+			decodeAverage<BPP>( io_row, i_prev, i_len, i_bpp );
+			break;
+		case 4:
+			decodePaeth<BPP>( io_row, i_prev, i_len, i_bpp );
+			break;
+		default:
+			break;
+	}
+}
+
+void decodeRow( int i_predictor,
+                uint8_t *io_row,
+                const uint8_t *i_prev,
+                size_t i_len,
+                int i_bpp )
+{
+	switch ( i_bpp )
+	{
+		case 1:
+			decodeRow<1>( i_predictor, io_row, i_prev, i_len, 1 );
+			break;
+		case 2:
+			decodeRow<2>( i_predictor, io_row, i_prev, i_len, 2 );
+			break;
+		case 3:
+			decodeRow<3>( i_predictor, io_row, i_prev, i_len, 3 );
+			break;
+		case 4:
+			decodeRow<4>( i_predictor, io_row, i_prev, i_len, 4 );
+			break;
+		case 6:
+			decodeRow<6>( i_predictor, io_row, i_prev, i_len, 6 );
+			break;
+		case 8:
+			decodeRow<8>( i_predictor, io_row, i_prev, i_len, 8 );
+			break;
+		default:
+			decodeRow<0>( i_predictor, io_row, i_prev, i_len, i_bpp );
+			break;
+	}
 }
 }
 
@@ -36,28 +240,27 @@ namespace pdfp {
 
 PNGPredictor::PNGPredictor( int i_width,
                                     int i_bitsPerComp,
-                                    int i_nbOfComp ) :
-    _width( i_width )
+                                    int i_nbOfComp )
 {
 	_bpp = ( i_nbOfComp * i_bitsPerComp + 7 ) >> 3;
 	assert( _bpp > 0 );
-	_rowBytes = ( ( _width * i_nbOfComp * i_bitsPerComp + 7 ) >> 3 );
-	_buffer = std::make_unique<uint8_t[]>( _rowBytes * 2 );
-	memset( _buffer.get(), 0, _rowBytes * 2 );
+	_rowBytes = ( ( i_width * i_nbOfComp * i_bitsPerComp + 7 ) >> 3 );
 
-	_previousRow = _buffer.get();
-	_currentRow = _previousRow + _rowBytes;
+	// whole rows, each after its predictor byte
+	size_t nbRows = std::max<size_t>( 1, kBatchSize / ( _rowBytes + 1 ) );
+	_batchCapacity = nbRows * ( _rowBytes + 1 );
+	_batch = std::make_unique<uint8_t[]>( _batchCapacity );
+	_previousRow = std::make_unique<uint8_t[]>( _rowBytes );
 
-	_pos = _rowBytes;
+	memset( _previousRow.get(), 0, _rowBytes );
+	_batchSize = _pos = 0;
 }
 
 void PNGPredictor::rewind()
 {
 	rewindNext();
-	memset( _buffer.get(), 0, _rowBytes * 2 );
-	_previousRow = _buffer.get();
-	_currentRow = _previousRow + _rowBytes;
-	_pos = _rowBytes;
+	memset( _previousRow.get(), 0, _rowBytes );
+	_batchSize = _pos = 0;
 }
 
 std::streamoff PNGPredictor::read( su::array_view<uint8_t> o_buffer )
@@ -65,10 +268,19 @@ std::streamoff PNGPredictor::read( su::array_view<uint8_t> o_buffer )
 	size_t s = 0;
 	while ( s < o_buffer.size() )
 	{
-		if ( _pos < _rowBytes )
+		if ( _pos < _batchSize )
 		{
-			auto ptr = _currentRow + _pos;
-			size_t l = std::min( _rowBytes - _pos, o_buffer.size() - s );
+			// skip the predictor bytes
+			size_t inRecord = _pos % ( _rowBytes + 1 );
+			if ( inRecord == 0 )
+			{
+				++_pos;
+				continue;
+			}
+			auto ptr = _batch.get() + _pos;
+			size_t l = std::min( { _rowBytes + 1 - inRecord,
+			                       _batchSize - _pos,
+			                       o_buffer.size() - s } );
 			std::copy( ptr, ptr + l, o_buffer.begin() + s );
 
 			s += l;
@@ -86,64 +298,38 @@ std::streamoff PNGPredictor::read( su::array_view<uint8_t> o_buffer )
 
 bool PNGPredictor::fillBuffer()
 {
-	// read a predictor
-	int p = getByteNext();
-	if ( p == EOF )
-		return false;
-
-	// read a row
-	std::swap( _previousRow, _currentRow );
-	_rowBytes = readNext( {_currentRow, _rowBytes} );
-
-	// decode
-	decodeCurrentRow( p );
-	_pos = 0;
+	size_t recordSize = _rowBytes + 1;
 
-	return _rowBytes > 0;
-}
+	// the last row decoded is the one above the next
+	if ( _batchSize >= recordSize )
+		memcpy( _previousRow.get(), _batch.get() + _batchSize - _rowBytes, _rowBytes );
 
-void PNGPredictor::decodeCurrentRow( int p )
-{
-	auto ptr = _currentRow;
-	auto end = _currentRow + _rowBytes;
-	auto ptrUp = _previousRow;
-	switch ( p )
+	// read rows
+	size_t len = 0;
+	while ( len < _batchCapacity )
 	{
-		case 1:
-		{
-			for ( int i = 0; i < _bpp; ++i )
-				++ptr;
-			for ( ; ptr < end; ++ptr )
-				*ptr = *ptr + *( ptr - _bpp );
-			break;
-		}
-		case 2:
-		{
-			for ( ; ptr < end; ++ptr, ++ptrUp )
-				*ptr = *ptr + *ptrUp;
-			break;
-		}
-		case 3:
-		{
-			for ( int i = 0; i < _bpp; ++i, ++ptr, ++ptrUp )
-				*ptr = *ptr + ( ( *ptrUp ) >> 1 );
-			for ( ; ptr < end; ++ptr, ++ptrUp )
-				*ptr =
-				    *ptr + ( ( int( *ptrUp ) + int( *( ptr - _bpp ) ) ) >> 1 );
+		auto r = readNext( {_batch.get() + len, _batchCapacity - len} );
+		if ( r <= 0 )
 			break;
-		}
-		case 4:
-		{
-			for ( int i = 0; i < _bpp; ++i, ++ptr, ++ptrUp )
-				*ptr = *ptr + PaethPredictor( 0, *ptrUp, 0 );
+		len += r;
+	}
+	// a truncated last row is decoded as far as it goes, without its
+	// predictor byte there is nothing
+	if ( len % recordSize == 1 )
+		--len;
+	_batchSize = len;
+	_pos = 0;
+	if ( len == 0 )
+		return false;
 
-			for ( ; ptr < end; ++ptr, ++ptrUp )
-				*ptr = *ptr + PaethPredictor(
-				                  *( ptr - _bpp ), *ptrUp, *( ptrUp - _bpp ) );
-			break;
-		}
-		default:
-			break;
+	// decode
+	const uint8_t *prev = _previousRow.get();
+	for ( size_t p = 0; p < len; p += recordSize )
+	{
+		auto row = _batch.get() + p + 1;
+		decodeRow( _batch[p], row, prev, std::min( _rowBytes, len - p - 1 ), _bpp );
+		prev = row;
 	}
+	return true;
 }
 }
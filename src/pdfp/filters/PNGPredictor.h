@@ -24,16 +24,16 @@ public:
 	virtual std::streamoff read( su::array_view<uint8_t> o_buffer );
 
 private:
-	int _width;
-	size_t _pos, _rowBytes;
+	size_t _rowBytes;
 	int _bpp;
-	std::unique_ptr<uint8_t[]> _buffer;
-	uint8_t *_previousRow;
-	uint8_t *_currentRow;
+	//! rows read at once from the next filter, each one after its
+	//! predictor byte, decoded in place
+	std::unique_ptr<uint8_t[]> _batch;
+	size_t _batchCapacity, _batchSize, _pos;
+	//! the last row of the previous batch
+	std::unique_ptr<uint8_t[]> _previousRow;
 
 	bool fillBuffer();
-
-	void decodeCurrentRow( int p );
 };
 }
 
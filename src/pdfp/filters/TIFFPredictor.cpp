@@ -8,33 +8,248 @@
 
 #include "TIFFPredictor.h"
 #include "su/base/endian.h"
-#include <cassert>
-#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+#if defined( __SSE2__ ) or defined( _M_X64 ) or \
+    ( defined( _M_IX86_FP ) and _M_IX86_FP >= 2 )
+#	define PDFP_TIFF_SSE2 1
+#	include <emmintrin.h>
+#endif
+
+namespace {
+
+//! read about that much from the next filter at once
+const size_t kBatchSize = 64 * 1024;
+
+// Each sample is added to the one i_nbOfComp samples before it, modulo
+// 2^bitsPerComp, a row starts from 0. That is a prefix sum with a stride,
+// computed on whole words: a 64 bits big endian word holds the samples in
+// order in lanes of BPC bits, w + ( w >> stride ) adds to every sample the
+// one before, then doubling the shift sums the whole word in log steps.
+// With 1 bit samples the add is a xor.
+
+template <int BPC>
+inline uint64_t laneAdd( uint64_t a, uint64_t b )
+{
+	// the high bit of each lane, added without carry
+	const uint64_t H = ( ~uint64_t( 0 ) / ( ( uint64_t( 1 ) << BPC ) - 1 ) ) *
+	                   ( uint64_t( 1 ) << ( BPC - 1 ) );
+	return ( ( a & ~H ) + ( b & ~H ) ) ^ ( ( a ^ b ) & H );
+}
+
+template <int BPC>
+inline uint64_t prefixSum( uint64_t w, int i_stride )
+{
+	for ( int shift = i_stride; shift < 64; shift <<= 1 )
+		w = laneAdd<BPC>( w, w >> shift );
+	return w;
+}
+
+//! decode from i_start, a multiple of 8, the stride is less than 64 bits
+template <int BPC>
+void decodeWords( uint8_t *io_row, size_t i_len, size_t i_start, int i_stride )
+{
+	uint64_t prev = 0;
+	if ( i_start > 0 )
+	{
+		memcpy( &prev, io_row + i_start - 8, 8 );
+		prev = su::big_to_native( prev );
+	}
+	for ( size_t i = i_start; i < i_len; i += 8 )
+	{
+		// the last partial word is padded with zeros
+		size_t l = std::min<size_t>( 8, i_len - i );
+		uint64_t w = 0;
+		memcpy( &w, io_row + i, l );
+		w = su::big_to_native( w );
+
+		// the samples of the previous word carried to the first ones
+		w = laneAdd<BPC>( w, prev << ( 64 - i_stride ) );
+		w = prefixSum<BPC>( w, i_stride );
+		prev = w;
+
+		w = su::native_to_big( w );
+		memcpy( io_row + i, &w, l );
+	}
+}
+
+#if PDFP_TIFF_SSE2
+template <int BPC>
+inline __m128i add( __m128i a, __m128i b )
+{
+	return BPC == 16 ? _mm_add_epi16( a, b ) : _mm_add_epi8( a, b );
+}
+inline __m128i swap16( __m128i x )
+{
+	return _mm_or_si128( _mm_slli_epi16( x, 8 ), _mm_srli_epi16( x, 8 ) );
+}
+
+//! same as decodeWords() on 16 bytes, the byte swap of 16 bits samples
+//! is done in the same pass, return the number of bytes decoded
+template <int BPC, int SB>
+size_t decodeBlocks( uint8_t *io_row, size_t i_len )
+{
+	static_assert( 16 % SB == 0, "a pixel must not straddle blocks" );
+	__m128i prev = _mm_setzero_si128();
+	size_t i = 0;
+	for ( ; i + 16 <= i_len; i += 16 )
+	{
+		auto x = _mm_loadu_si128( (const __m128i *)( io_row + i ) );
+		if ( BPC == 16 )
+			x = swap16( x );
+		x = add<BPC>( x, _mm_srli_si128( prev, 16 - SB ) );
+		x = add<BPC>( x, _mm_slli_si128( x, SB ) );
+		if constexpr ( 2 * SB < 16 )
+			x = add<BPC>( x, _mm_slli_si128( x, 2 * SB ) );
+		if constexpr ( 4 * SB < 16 )
+			x = add<BPC>( x, _mm_slli_si128( x, 4 * SB ) );
+		if constexpr ( 8 * SB < 16 )
+			x = add<BPC>( x, _mm_slli_si128( x, 8 * SB ) );
+		prev = x;
+		if ( BPC == 16 )
+			x = swap16( x );
+		_mm_storeu_si128( (__m128i *)( io_row + i ), x );
+	}
+	return i;
+}
+
+template <int BPC>
+size_t decodeBlocks( uint8_t *io_row, size_t i_len, int i_stride )
+{
+	switch ( i_stride )
+	{
+		case 8:
+			return decodeBlocks<BPC, 1>( io_row, i_len );
+		case 16:
+			return decodeBlocks<BPC, 2>( io_row, i_len );
+		case 32:
+			return decodeBlocks<BPC, 4>( io_row, i_len );
+		case 64:
+			return decodeBlocks<BPC, 8>( io_row, i_len );
+		default:
+			return 0;
+	}
+}
+#endif
+
+//! a sample at a time from byte i_start, for the wide pixels
+void decodeSamples( uint8_t *io_row,
+                    size_t i_len,
+                    size_t i_start,
+                    int i_bpc,
+                    int i_nbOfComp )
+{
+	switch ( i_bpc )
+	{
+		case 8:
+			for ( size_t i = std::max<size_t>( i_nbOfComp, i_start ); i < i_len; ++i )
+				io_row[i] += io_row[i - i_nbOfComp];
+			break;
+		case 16:
+		{
+			// big endian in, big endian out
+			size_t stride = 2 * i_nbOfComp;
+			for ( size_t i = std::max( stride, i_start ); i + 1 < i_len; i += 2 )
+			{
+				uint16_t v = ( io_row[i] << 8 ) | io_row[i + 1];
+				v += ( io_row[i - stride] << 8 ) | io_row[i - stride + 1];
+				io_row[i] = uint8_t( v >> 8 );
+				io_row[i + 1] = uint8_t( v );
+			}
+			break;
+		}
+		default:
+		{
+			const int mask = ( 1 << i_bpc ) - 1;
+			auto sample = [&]( size_t j ) {
+				size_t bit = j * i_bpc;
+				return ( io_row[bit >> 3] >> ( 8 - i_bpc - ( bit & 7 ) ) ) & mask;
+			};
+			size_t nbSamples = ( i_len * 8 ) / i_bpc;
+			size_t first = std::max<size_t>( i_nbOfComp, ( i_start * 8 ) / i_bpc );
+			for ( size_t j = first; j < nbSamples; ++j )
+			{
+				size_t bit = j * i_bpc;
+				int shift = 8 - i_bpc - ( bit & 7 );
+				int v = ( sample( j ) + sample( j - i_nbOfComp ) ) & mask;
+				auto &b = io_row[bit >> 3];
+				b = uint8_t( ( b & ~( mask << shift ) ) | ( v << shift ) );
+			}
+			break;
+		}
+	}
+}
+
+template <int BPC>
+void decodeRow( uint8_t *io_row, size_t i_len, int i_nbOfComp )
+{
+	// the half of a truncated 16 bits sample is left as is
+	if constexpr ( BPC == 16 )
+		i_len &= ~size_t( 1 );
+
+	int stride = BPC * i_nbOfComp;
+	size_t start = 0;
+#if PDFP_TIFF_SSE2
+	if constexpr ( BPC >= 8 )
+		start = decodeBlocks<BPC>( io_row, i_len, stride );
+#endif
+	if ( stride < 64 )
+		decodeWords<BPC>( io_row, i_len, start, stride );
+	else
+		decodeSamples( io_row, i_len, start, BPC, i_nbOfComp );
+}
+
+void decodeRow( uint8_t *io_row, size_t i_len, int i_bpc, int i_nbOfComp )
+{
+	switch ( i_bpc )
+	{
+		case 1:
+			decodeRow<1>( io_row, i_len, i_nbOfComp );
+			break;
+		case 2:
+			decodeRow<2>( io_row, i_len, i_nbOfComp );
+			break;
+		case 4:
+			decodeRow<4>( io_row, i_len, i_nbOfComp );
+			break;
+		case 8:
+			decodeRow<8>( io_row, i_len, i_nbOfComp );
+			break;
+		case 16:
+			decodeRow<16>( io_row, i_len, i_nbOfComp );
+			break;
+		default:
+			// not a valid BitsPerComponent, leave the data as is
+			break;
+	}
+}
+}
 
 namespace pdfp {
 
 TIFFPredictor::TIFFPredictor( size_t i_width,
                                       int i_bitsPerComp,
                                       int i_nbOfComp ) :
-    _width( i_width ),
-    _rowBytes( ( ( i_width * i_nbOfComp * i_bitsPerComp + 7 ) >> 3 ) ),
-    _bytesPerComp( ( i_nbOfComp * i_bitsPerComp + 7 ) >> 3 ),
-    _nbOfComp( i_nbOfComp ),
-    _bitsPerComp( i_bitsPerComp )
+    _rowBytes( i_nbOfComp > 0 and i_bitsPerComp > 0
+                   ? ( ( i_width * i_nbOfComp * i_bitsPerComp + 7 ) >> 3 )
+                   : 0 ),
+    _bitsPerComp( i_bitsPerComp ),
+    _nbOfComp( i_nbOfComp )
 {
-	assert( _bytesPerComp > 0 );
-
-	_buffer = std::make_unique<uint8_t[]>( _rowBytes );
-	memset( _buffer.get(), 0, _rowBytes );
-
-	_pos = _rowBytes;
+	// without a row there is nothing to read, read() returns EOF
+	size_t nbRows = 0;
+	if ( _rowBytes > 0 )
+		nbRows = std::max<size_t>( 1, kBatchSize / _rowBytes );
+	_batchCapacity = nbRows * _rowBytes;
+	_batch = std::make_unique<uint8_t[]>( _batchCapacity );
+	_batchSize = _pos = 0;
 }
 
 void TIFFPredictor::rewind()
 {
 	rewindNext();
-	memset( _buffer.get(), 0, _rowBytes );
-	_pos = _rowBytes;
+	_batchSize = _pos = 0;
 }
 
 std::streamoff TIFFPredictor::read( su::array_view<uint8_t> o_buffer )
@@ -42,10 +257,10 @@ std::streamoff TIFFPredictor::read( su::array_view<uint8_t> o_buffer )
 	size_t s = 0;
 	while ( s < o_buffer.size() )
 	{
-		if ( _pos < _rowBytes )
+		if ( _pos < _batchSize )
 		{
-			auto ptr = _buffer.get() + _pos;
-			auto l = std::min( _rowBytes - _pos, o_buffer.size() - s );
+			auto ptr = _batch.get() + _pos;
+			auto l = std::min( _batchSize - _pos, o_buffer.size() - s );
 			std::copy( ptr, ptr + l, o_buffer.begin() + s );
 
 			s += l;
@@ -63,60 +278,26 @@ std::streamoff TIFFPredictor::read( su::array_view<uint8_t> o_buffer )
 
 bool TIFFPredictor::fillBuffer()
 {
-	// read a row
-	_rowBytes = readNext( {_buffer.get(), (size_t)_rowBytes} );
-
-	// decode
-	decodeCurrentRow();
-	_pos = 0;
-
-	return _rowBytes > 0;
-}
-
-void TIFFPredictor::decodeCurrentRow()
-{
-	auto ptr = _buffer.get();
-
-	switch ( _bitsPerComp )
+	// read rows, a short read is not the end of a row
+	size_t len = 0;
+	while ( len < _batchCapacity )
 	{
-		case 1:
-		{
-			assert( false );
-			auto row = (uint8_t *)ptr;
-			auto b = row[_bytesPerComp - 1];
-			for ( auto i = _bytesPerComp; i < _rowBytes; i += 8 )
-			{
-				// 1-bit add is just xor
-				b = ( b << 8 ) | row[i];
-				row[i] ^= b >> _nbOfComp;
-			}
-			break;
-		}
-		case 8:
-		{
-			auto row = (uint8_t *)ptr;
-			auto width = _rowBytes;
-			for ( auto i = _nbOfComp; i < width; ++i )
-				row[i] += row[i - _nbOfComp];
+		auto r = readNext( {_batch.get() + len, _batchCapacity - len} );
+		if ( r <= 0 )
 			break;
-		}
-		case 16:
-		{
-			auto row = (uint16_t *)ptr;
-			auto width = _rowBytes / 2;
-			for ( auto i = 0; i < width; ++i )
-				row[i] = su::big_to_native( row[i] );
-			for ( auto i = _nbOfComp; i < width; ++i )
-				row[i] += row[i - _nbOfComp];
-			for ( auto i = 0; i < width; ++i )
-				row[i] = su::native_to_big( row[i] );
-			break;
-		}
-		default:
-		{
-			assert( false );
-			break;
-		}
+		len += r;
 	}
+	_batchSize = len;
+	_pos = 0;
+	if ( len == 0 )
+		return false;
+
+	// decode, a truncated last row as far as it goes
+	for ( size_t p = 0; p < len; p += _rowBytes )
+		decodeRow( _batch.get() + p,
+		           std::min( _rowBytes, len - p ),
+		           _bitsPerComp,
+		           _nbOfComp );
+	return true;
 }
 }
@@ -23,18 +23,15 @@ public:
 	virtual std::streamoff read( su::array_view<uint8_t> o_buffer );
 
 private:
-	[[maybe_unused]] const size_t _width;
-	ssize_t _rowBytes;
-	const int _bytesPerComp;
-	const int _nbOfComp;
+	const size_t _rowBytes;
 	const int _bitsPerComp;
+	const int _nbOfComp;
 
-	size_t _pos;
-	std::unique_ptr<uint8_t[]> _buffer;
+	//! whole rows read at once from the next filter, decoded in place
+	std::unique_ptr<uint8_t[]> _batch;
+	size_t _batchCapacity, _batchSize, _pos;
 
 	bool fillBuffer();
-
-	void decodeCurrentRow();
 };
 }
 
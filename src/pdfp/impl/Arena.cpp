@@ -0,0 +1,62 @@
+//
+//  Arena.cpp
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#include "Arena.h"
+
+namespace pdfp {
+
+Arena::Arena( size_t i_blockSize ) :
+    _blockSize( i_blockSize )
+{
+}
+
+void *Arena::allocate( size_t i_len )
+{
+	std::unique_lock<std::mutex> lock( _mutex, std::defer_lock );
+	if ( _shared )
+		lock.lock();
+
+	i_len = ( i_len + 7 ) & ~size_t( 7 );
+	_used += i_len;
+
+	// big ones get their own block, the current one stays in use
+	if ( i_len > ( _blockSize / 4 ) )
+	{
+		_blocks.push_back( std::make_unique<char[]>( i_len ) );
+		_reserved += i_len;
+		return _blocks.back().get();
+	}
+
+	if ( size_t( _end - _cur ) < i_len )
+	{
+		_blocks.push_back( std::make_unique<char[]>( _blockSize ) );
+		_reserved += _blockSize;
+		_cur = _blocks.back().get();
+		_end = _cur + _blockSize;
+	}
+	auto ptr = _cur;
+	_cur += i_len;
+	return ptr;
+}
+
+void Arena::keep( Object &&i_obj )
+{
+	std::unique_lock<std::mutex> lock( _mutex, std::defer_lock );
+	if ( _shared )
+		lock.lock();
+	_kept.push_back( std::move( i_obj ) );
+}
+
+void Arena::keep( Name &&i_name )
+{
+	std::unique_lock<std::mutex> lock( _mutex, std::defer_lock );
+	if ( _shared )
+		lock.lock();
+	_keptNames.push_back( std::move( i_name ) );
+}
+}
@@ -0,0 +1,67 @@
+//
+//  Arena.h
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#ifndef H_PDFP_Arena
+#define H_PDFP_Arena
+
+#include "pdfp/PDFObject.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace pdfp {
+
+/*!
+   @brief bump allocator for the objects of a document.
+
+       Memory is carved from large blocks and never given back individually,
+   everything is released at once when the arena is destroyed. The values
+   allocated here are never destroyed one by one either: the references
+   they hold to names and values outside of the arena are kept by the
+   arena and released with it.
+*/
+class Arena
+{
+public:
+	explicit Arena( size_t i_blockSize = 64 * 1024 );
+	~Arena() = default;
+
+	Arena( const Arena & ) = delete;
+	Arena &operator=( const Arena & ) = delete;
+
+	//! i_len bytes aligned on 8 bytes
+	void *allocate( size_t i_len );
+	//! hold a reference until the arena goes away
+	void keep( Object &&i_obj );
+	void keep( Name &&i_name );
+
+	//! lock in allocate(), while several threads parse objects
+	void setShared( bool i_shared ) { _shared = i_shared; }
+
+	//! bytes handed out
+	size_t used() const { return _used; }
+	//! bytes allocated from the system
+	size_t reserved() const { return _reserved; }
+
+private:
+	const size_t _blockSize;
+	std::vector<std::unique_ptr<char[]>> _blocks;
+	//! after the blocks, released before the values they point to
+	std::vector<Object> _kept;
+	std::vector<Name> _keptNames;
+	char *_cur = nullptr;
+	char *_end = nullptr;
+	size_t _used = 0;
+	size_t _reserved = 0;
+	bool _shared = false;
+	std::mutex _mutex;
+};
+}
+
+#endif
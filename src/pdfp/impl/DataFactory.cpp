@@ -9,6 +9,7 @@
 
 #include "DataFactory.h"
 #include "ImageStreamInfo.h"
+#include "Keywords.h"
 #include "pdfp/PDFDocument.h"
 #include "pdfp/filters/ASCII85.h"
 #include "pdfp/filters/ASCIIHex.h"
@@ -23,6 +24,7 @@
 #include "pdfp/security/SecurityHandler.h"
 #include "su/log/logger.h"
 #include <cassert>
+#include <climits>
 
 namespace pdfp {
 
@@ -164,21 +166,40 @@ class DataStream : public AbstractDataStream
 {
 public:
 	DataStream( std::unique_ptr<InputSource> i_input );
+	DataStream( const char *i_ptr, size_t i_length );
 	virtual ~DataStream() = default;
 
 	void pushFilter( std::unique_ptr<InputFilter> i_filter );
 	bool pushFilter( const std::string &i_name,
 	                 const Object &i_decodeParams );
 	void pushPredictor( const Object &i_decodeParams );
+	//! stop after i_size decoded bytes
+	void pushLimit( size_t i_size );
+	//! the expected decoded size (DL entry)
+	void setSizeHint( size_t i_size ) { _sizeHint = i_size; }
 
 	virtual std::streamoff read( su::array_view<uint8_t> o_buffer );
 	virtual data_format_t format() const;
+	virtual bool view( su::array_view<const uint8_t> &o_view ) const;
+
+protected:
+	virtual bool decodeAll( Data &o_data );
 
 private:
 	data_format_t _format;
 
 	std::unique_ptr<InputSource> _input;
 
+	//! the raw data, valid as long as no filter is pushed
+	const uint8_t *_viewPtr = nullptr;
+	size_t _viewLength = 0;
+
+	//! the raw data when in memory, and Flate the only filter
+	const uint8_t *_flatePtr = nullptr;
+	size_t _flateLength = 0;
+	size_t _limit = 0;
+	size_t _sizeHint = 0;
+
 	template<typename T, int NC>
 	bool choose_predictor_format( size_t width, int bpp, int c );
 
@@ -193,8 +214,18 @@ DataStream::DataStream( std::unique_ptr<InputSource> i_input ) :
 {
 }
 
+DataStream::DataStream( const char *i_ptr, size_t i_length ) :
+    _format( data_format_t::kRaw ),
+    _input( std::make_unique<BufferSource>( i_ptr, i_length ) ),
+    _viewPtr( (const uint8_t *)i_ptr ),
+    _viewLength( i_length )
+{
+}
+
 std::streamoff DataStream::read( su::array_view<uint8_t> o_buffer )
 {
+	// decodeAll() starts from the beginning
+	_flatePtr = nullptr;
 	return _input->read( o_buffer );
 }
 
@@ -203,90 +234,121 @@ data_format_t DataStream::format() const
 	return _format;
 }
 
+bool DataStream::view( su::array_view<const uint8_t> &o_view ) const
+{
+	if ( _viewPtr == nullptr )
+		return false;
+	o_view = su::array_view<const uint8_t>( _viewPtr, _viewLength );
+	return true;
+}
+
+bool DataStream::decodeAll( Data &o_data )
+{
+	if ( _flatePtr == nullptr )
+		return false;
+	FlateDecode::decodeAll(
+	    {_flatePtr, _flateLength}, _sizeHint, _limit, o_data );
+	return true;
+}
+
 void DataStream::pushFilter( std::unique_ptr<InputFilter> i_filter )
 {
 	i_filter->setNext( std::move( _input ) );
 	_input = std::move( i_filter );
+	_viewPtr = nullptr;
+	_flatePtr = nullptr;
 }
 
 bool DataStream::pushFilter( const std::string &i_name,
                            const Object &i_decodeParams )
 {
-	if ( i_name == "FlateDecode" or i_name == "Fl" )
-	{
-		pushFilter( std::make_unique<FlateDecode>() );
-		if ( not i_decodeParams.is_null() )
-			pushPredictor( i_decodeParams );
-	}
-	else if ( i_name == "CCITTFaxDecode" or i_name == "CCF" )
-	{
-		int K = getParamInt( i_decodeParams, "K", 0 );
-		bool EndOfLine = getParamBool( i_decodeParams, "EndOfLine", false );
-		bool EncodedByteAlign =
-		    getParamBool( i_decodeParams, "EncodedByteAlign", false );
-		int Columns = getParamInt( i_decodeParams, "Columns", 1728 );
-		int Rows = getParamInt( i_decodeParams, "Rows", 0 );
-		bool EndOfBlock = getParamBool( i_decodeParams, "EndOfBlock", true );
-		bool BlackIs1 = getParamBool( i_decodeParams, "BlackIs1", false );
-		int DamagedRowsBeforeError =
-		    getParamInt( i_decodeParams, "DamagedRowsBeforeError", 0 );
-		pushFilter( std::make_unique<CCITTFaxDecode>(
-		    K,
-		    EndOfLine,
-		    EncodedByteAlign,
-		    Columns,
-		    Rows,
-		    EndOfBlock,
-		    BlackIs1,
-		    DamagedRowsBeforeError ) );
-	}
-	else if ( i_name == "ASCIIHexDecode" or i_name == "AHx" )
-	{
-		pushFilter( std::make_unique<ASCIIHexDecode>() );
-	}
-	else if ( i_name == "ASCII85Decode" or i_name == "A85" )
-	{
-		pushFilter( std::make_unique<ASCII85Decode>() );
-	}
-	else if ( i_name == "LZWDecode" or i_name == "LZW" )
-	{
-		int EarlyChange = getParamInt( i_decodeParams, "EarlyChange", 1 );
-		pushFilter( std::make_unique<LZWDecode>( EarlyChange ) );
-	}
-	else if ( i_name == "RunLengthDecode" or i_name == "RL" )
-	{
-		pushFilter( std::make_unique<RunLengthDecode>() );
-	}
-	else if ( i_name == "DCTDecode" or i_name == "DCT" )
-	{
-		_format = data_format_t::kJPEGEncoded;
-		return false;
-	}
-	else if ( i_name == "JPXDecode" )
-	{
-		_format = data_format_t::kJPEG2000;
-		return false;
-	}
-	else if ( i_name == "JBIG2Decode" )
-	{
-		auto globals = getParamStream( i_decodeParams, "JBIG2Globals" );
-		pushFilter( std::make_unique<JBIG2Decode>( globals ) );
-	}
-	else if ( i_name == "Crypt" )
+	switch ( keyword( i_name ) )
 	{
-		std::string name = getParamName( i_decodeParams, "Name" );
-		if ( not name.empty() and name != "Identity" )
+		case Keyword::kw_FlateDecode:
+		case Keyword::kw_Fl:
 		{
-			log_error() << "unkown filter: " << i_name << " - " << name;
-			assert( false );
+			// the first filter on data in memory can be decoded at once
+			auto ptr = _viewPtr;
+			auto len = _viewLength;
+			pushFilter( std::make_unique<FlateDecode>() );
+			_flatePtr = ptr;
+			_flateLength = len;
+			if ( not i_decodeParams.is_null() )
+				pushPredictor( i_decodeParams );
+			break;
+		}
+		case Keyword::kw_CCITTFaxDecode:
+		case Keyword::kw_CCF:
+		{
+			int K = getParamInt( i_decodeParams, "K", 0 );
+			bool EndOfLine = getParamBool( i_decodeParams, "EndOfLine", false );
+			bool EncodedByteAlign =
+			    getParamBool( i_decodeParams, "EncodedByteAlign", false );
+			int Columns = getParamInt( i_decodeParams, "Columns", 1728 );
+			int Rows = getParamInt( i_decodeParams, "Rows", 0 );
+			bool EndOfBlock =
+			    getParamBool( i_decodeParams, "EndOfBlock", true );
+			bool BlackIs1 = getParamBool( i_decodeParams, "BlackIs1", false );
+			int DamagedRowsBeforeError =
+			    getParamInt( i_decodeParams, "DamagedRowsBeforeError", 0 );
+			pushFilter( std::make_unique<CCITTFaxDecode>(
+			    K,
+			    EndOfLine,
+			    EncodedByteAlign,
+			    Columns,
+			    Rows,
+			    EndOfBlock,
+			    BlackIs1,
+			    DamagedRowsBeforeError ) );
+			break;
+		}
+		case Keyword::kw_ASCIIHexDecode:
+		case Keyword::kw_AHx:
+			pushFilter( std::make_unique<ASCIIHexDecode>() );
+			break;
+		case Keyword::kw_ASCII85Decode:
+		case Keyword::kw_A85:
+			pushFilter( std::make_unique<ASCII85Decode>() );
+			break;
+		case Keyword::kw_LZWDecode:
+		case Keyword::kw_LZW:
+		{
+			int EarlyChange = getParamInt( i_decodeParams, "EarlyChange", 1 );
+			pushFilter( std::make_unique<LZWDecode>( EarlyChange ) );
+			break;
+		}
+		case Keyword::kw_RunLengthDecode:
+		case Keyword::kw_RL:
+			pushFilter( std::make_unique<RunLengthDecode>() );
+			break;
+		case Keyword::kw_DCTDecode:
+		case Keyword::kw_DCT:
+			_format = data_format_t::kJPEGEncoded;
+			return false;
+		case Keyword::kw_JPXDecode:
+			_format = data_format_t::kJPEG2000;
 			return false;
+		case Keyword::kw_JBIG2Decode:
+		{
+			auto globals = getParamStream( i_decodeParams, "JBIG2Globals" );
+			pushFilter( std::make_unique<JBIG2Decode>( globals ) );
+			break;
 		}
-	}
-	else
-	{
-		log_error() << "unkown filter: " << i_name;
-		assert( false );
-		return false;
+		case Keyword::kw_Crypt:
+		{
+			std::string name = getParamName( i_decodeParams, "Name" );
+			if ( not name.empty() and name != "Identity" )
+			{
+				log_error() << "unkown filter: " << i_name << " - " << name;
+				assert( false );
+				return false;
+			}
+			break;
+		}
+		default:
+			log_error() << "unkown filter: " << i_name;
+			assert( false );
+			return false;
 	}
 	return true;
 }
@@ -313,6 +375,17 @@ void DataStream::pushPredictor( const Object &i_decodeParams )
 	if ( Colors.is_number() )
 		c = Colors.int_value();
 
+	// a row must have at least one byte, and its size must fit in an int
+	if ( p != 1 and ( width < 1 or c < 1 or
+	                  ( bpc != 1 and bpc != 2 and bpc != 4 and bpc != 8 and
+	                    bpc != 16 ) or
+	                  ( int64_t( width ) * c * bpc ) > INT_MAX ) )
+	{
+		log_warn() << "invalid predictor parameters, Columns " << width
+		           << " Colors " << c << " BitsPerComponent " << bpc;
+		return;
+	}
+
 	switch ( p )
 	{
 		case 1:
@@ -322,6 +395,7 @@ void DataStream::pushPredictor( const Object &i_decodeParams )
 			auto n = std::make_unique<TIFFPredictor>( width, bpc, c );
 			n->setNext( std::move( _input ) );
 			_input = std::move( n );
+			_flatePtr = nullptr;
 			break;
 		}
 		case 10:
@@ -334,6 +408,7 @@ void DataStream::pushPredictor( const Object &i_decodeParams )
 			auto n = std::make_unique<PNGPredictor>( width, bpc, c );
 			n->setNext( std::move( _input ) );
 			_input = std::move( n );
+			_flatePtr = nullptr;
 			break;
 		}
 		default:
@@ -386,6 +461,14 @@ std::streamoff DataStreamLimiter::read( su::array_view<uint8_t> o_buffer )
 		return 0;
 }
 
+void DataStream::pushLimit( size_t i_size )
+{
+	auto flatePtr = _flatePtr;
+	pushFilter( std::make_unique<DataStreamLimiter>( i_size ) );
+	_flatePtr = flatePtr;
+	_limit = i_size;
+}
+
 // MARK: -
 
 std::vector<std::pair<std::string, const Object>> collectFilters(
@@ -393,7 +476,9 @@ std::vector<std::pair<std::string, const Object>> collectFilters(
 {
 	std::vector<std::pair<std::string, const Object>> filterList;
 
-	auto &filter = i_dictionary["Filter"];
+	static const Name kFilter( "Filter" ), kDecodeParms( "DecodeParms" ),
+	    kDP( "DP" );
+	auto &filter = i_dictionary[kFilter];
 	if ( not filter.is_null() )
 	{
 		std::vector<std::string> nameList;
@@ -410,9 +495,9 @@ std::vector<std::pair<std::string, const Object>> collectFilters(
 		std::vector<const Object> paramList;
 		paramList.reserve( nameList.size() );
 
-		auto decodeParams = i_dictionary["DecodeParms"];
+		auto decodeParams = i_dictionary[kDecodeParms];
 		if ( decodeParams.is_null() )
-			decodeParams = i_dictionary["DP"];
+			decodeParams = i_dictionary[kDP];
 		if ( not decodeParams.is_null() )
 		{
 			if ( decodeParams.is_array() )
@@ -446,11 +531,20 @@ DataStreamRef createDataStream( const Object &i_dict,
 {
 	auto filterList = collectFilters( i_dict );
 
-	auto data = std::make_unique<DataStream>(
-	    std::make_unique<DocSource>( i_dict.document(), i_offset, i_length ) );
+	// work directly on the file content if it is in memory
+	std::unique_ptr<DataStream> data;
+	auto ptr = i_dict.document()->memoryData( i_offset, i_length );
+	if ( ptr != nullptr )
+		data = std::make_unique<DataStream>( ptr, i_length );
+	else
+	{
+		data = std::make_unique<DataStream>( std::make_unique<DocSource>(
+		    i_dict.document(), i_offset, i_length ) );
+	}
 
 	bool isMetadata = false;
-	auto mdtype = i_dict["Type"];
+	static const Name kType( "Type" );
+	auto mdtype = i_dict[kType];
 	if ( not mdtype.is_null() )
 	{
 		if ( mdtype.name_value() == "Metadata" )
@@ -469,10 +563,11 @@ DataStreamRef createDataStream( const Object &i_dict,
 			break;
 		else
 		{
-			if ( filter->first == "FlateDecode" or filter->first == "Fl" )
+			auto k = keyword( filter->first );
+			if ( k == Keyword::kw_FlateDecode or k == Keyword::kw_Fl )
 				needLimit = true;
-			if ( filter->first == "CCITTFaxDecode" or filter->first == "CCF" or
-			     filter->first == "JBIG2Decode" )
+			if ( k == Keyword::kw_CCITTFaxDecode or k == Keyword::kw_CCF or
+			     k == Keyword::kw_JBIG2Decode )
 				needLimit = isBitmap = true;
 		}
 	}
@@ -483,10 +578,13 @@ DataStreamRef createDataStream( const Object &i_dict,
 		if ( getImageInfo( i_dict, isBitmap, width, height, bpc, cpp ) )
 		{
 			size_t rowBytes = ( ( ( width * cpp * bpc ) + 7 ) & ( ~7 ) ) / 8;
-			data->pushFilter(
-			    std::make_unique<DataStreamLimiter>( rowBytes * height ) );
+			data->pushLimit( rowBytes * height );
 		}
 	}
+	static const Name kDL( "DL" );
+	auto &DL = i_dict[kDL];
+	if ( DL.is_number() and DL.int_value() > 0 )
+		data->setSizeHint( DL.int_value() );
 	return data;
 }
 
@@ -498,8 +596,7 @@ DataStreamRef createDataStream( const Object &i_dict,
 {
 	auto filterList = collectFilters( i_dict );
 
-	auto data = std::make_unique<DataStream>(
-	    std::make_unique<BufferSource>( i_ptr, i_length ) );
+	auto data = std::make_unique<DataStream>( i_ptr, i_length );
 
 	bool needLimit = false, isBitmap = false;
 	auto filter = filterList.begin();
@@ -509,10 +606,11 @@ DataStreamRef createDataStream( const Object &i_dict,
 			break;
 		else
 		{
-			if ( filter->first == "FlateDecode" or filter->first == "Fl" )
+			auto k = keyword( filter->first );
+			if ( k == Keyword::kw_FlateDecode or k == Keyword::kw_Fl )
 				needLimit = true;
-			if ( filter->first == "CCITTFaxDecode" or filter->first == "CCF" or
-			     filter->first == "JBIG2Decode" )
+			if ( k == Keyword::kw_CCITTFaxDecode or k == Keyword::kw_CCF or
+			     k == Keyword::kw_JBIG2Decode )
 				needLimit = isBitmap = true;
 		}
 	}
@@ -523,17 +621,46 @@ DataStreamRef createDataStream( const Object &i_dict,
 		if ( getImageInfo( i_dict, isBitmap, width, height, bpc, cpp ) )
 		{
 			size_t rowBytes = ( ( ( width * cpp * bpc ) + 7 ) & ( ~7 ) ) / 8;
-			data->pushFilter(
-			    std::make_unique<DataStreamLimiter>( rowBytes * height ) );
+			data->pushLimit( rowBytes * height );
 		}
 	}
+	static const Name kDL( "DL" );
+	auto &DL = i_dict[kDL];
+	if ( DL.is_number() and DL.int_value() > 0 )
+		data->setSizeHint( DL.int_value() );
 	return data;
 }
 
+bool AbstractDataStream::view( su::array_view<const uint8_t> & ) const
+{
+	return false;
+}
+
+bool AbstractDataStream::decodeAll( Data & )
+{
+	return false;
+}
+
 Data AbstractDataStream::readAll()
 {
 	Data result;
-	
+
+	su::array_view<const uint8_t> raw;
+	if ( view( raw ) )
+	{
+		// no decoding needed, size is known: read all in one go
+		result.buffer = std::make_unique<uint8_t[]>( raw.size() );
+		auto l = read( {result.buffer.get(), raw.size()} );
+		result.length = l > 0 ? l : 0;
+		result.format = format();
+		return result;
+	}
+	if ( decodeAll( result ) )
+	{
+		result.format = format();
+		return result;
+	}
+
 	size_t capacity = 0;
 	for ( ;; )
 	{
@@ -0,0 +1,64 @@
+//
+//  FileMapping.cpp
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#include "FileMapping.h"
+
+#if !defined( _WIN32 )
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace pdfp {
+
+FileMapping::~FileMapping()
+{
+	close();
+}
+
+bool FileMapping::open( const std::string &i_path )
+{
+	close();
+#if defined( _WIN32 )
+	// not supported, caller fallback to regular reads
+	return false;
+#else
+	int fd = ::open( i_path.c_str(), O_RDONLY );
+	if ( fd < 0 )
+		return false;
+
+	struct stat st;
+	if ( ::fstat( fd, &st ) != 0 or st.st_size <= 0 )
+	{
+		::close( fd );
+		return false;
+	}
+
+	void *ptr = ::mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	// the mapping keeps its own reference on the file
+	::close( fd );
+	if ( ptr == MAP_FAILED )
+		return false;
+
+	_data = (const char *)ptr;
+	_size = st.st_size;
+	return true;
+#endif
+}
+
+void FileMapping::close()
+{
+#if !defined( _WIN32 )
+	if ( _data != nullptr )
+		::munmap( (void *)_data, _size );
+#endif
+	_data = nullptr;
+	_size = 0;
+}
+}
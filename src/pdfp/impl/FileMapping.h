@@ -0,0 +1,44 @@
+//
+//  FileMapping.h
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#ifndef H_PDFP_FileMapping
+#define H_PDFP_FileMapping
+
+#include <string>
+#include <cstddef>
+
+namespace pdfp {
+
+/*!
+   @brief read-only memory mapping of a whole file.
+
+       The mapping stays valid for the lifetime of the object.
+*/
+class FileMapping
+{
+public:
+	FileMapping() = default;
+	~FileMapping();
+
+	FileMapping( const FileMapping & ) = delete;
+	FileMapping &operator=( const FileMapping & ) = delete;
+
+	//! map the file, return false if the file cannot be mapped
+	bool open( const std::string &i_path );
+	void close();
+
+	const char *data() const { return _data; }
+	size_t size() const { return _size; }
+
+private:
+	const char *_data = nullptr;
+	size_t _size = 0;
+};
+}
+
+#endif
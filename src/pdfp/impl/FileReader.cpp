@@ -0,0 +1,89 @@
+//
+//  FileReader.cpp
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#include "FileReader.h"
+#include <cerrno>
+
+#if !defined( _WIN32 )
+#	include <fcntl.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace pdfp {
+
+#if defined( _WIN32 )
+
+FileReader::~FileReader() {}
+
+bool FileReader::open( const std::string &i_path )
+{
+	_file.open( i_path, std::ios_base::in | std::ios_base::binary );
+	if ( not _file )
+		return false;
+	_file.seekg( 0, std::ios_base::end );
+	_size = (size_t)_file.tellg();
+	return (bool)_file;
+}
+
+std::streamoff FileReader::read( size_t i_pos,
+                                 su::array_view<uint8_t> o_buffer ) const
+{
+	if ( i_pos >= _size )
+		return 0;
+	std::lock_guard<std::mutex> lock( _mutex );
+	_file.clear();
+	_file.seekg( i_pos, std::ios_base::beg );
+	_file.read( (char *)o_buffer.data(), o_buffer.size() );
+	return _file.gcount();
+}
+
+#else
+
+FileReader::~FileReader()
+{
+	if ( _fd >= 0 )
+		::close( _fd );
+}
+
+bool FileReader::open( const std::string &i_path )
+{
+	_fd = ::open( i_path.c_str(), O_RDONLY );
+	if ( _fd < 0 )
+		return false;
+	struct stat st;
+	if ( ::fstat( _fd, &st ) != 0 )
+		return false;
+	_size = st.st_size;
+	return true;
+}
+
+std::streamoff FileReader::read( size_t i_pos,
+                                 su::array_view<uint8_t> o_buffer ) const
+{
+	size_t s = 0;
+	while ( s < o_buffer.size() )
+	{
+		auto r = ::pread( _fd, o_buffer.data() + s, o_buffer.size() - s,
+		                  i_pos + s );
+		if ( r < 0 and errno == EINTR )
+			continue;
+		if ( r <= 0 )
+			break;
+		s += r;
+	}
+	return s;
+}
+
+#endif
+
+size_t FileReader::size() const
+{
+	return _size;
+}
+}
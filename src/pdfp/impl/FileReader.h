@@ -0,0 +1,51 @@
+//
+//  FileReader.h
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#ifndef H_PDFP_FileReader
+#define H_PDFP_FileReader
+
+#include "pdfp/PDFReader.h"
+#include <string>
+#if defined( _WIN32 )
+#	include <fstream>
+#	include <mutex>
+#endif
+
+namespace pdfp {
+
+/*!
+   @brief positional reads in a file.
+
+       No shared file position, reads can be done from any thread.
+*/
+class FileReader : public RandomAccessReader
+{
+public:
+	FileReader() = default;
+	virtual ~FileReader();
+
+	//! open the file, return false if the file cannot be read
+	bool open( const std::string &i_path );
+
+	virtual size_t size() const;
+	virtual std::streamoff read( size_t i_pos,
+	                             su::array_view<uint8_t> o_buffer ) const;
+
+private:
+	size_t _size = 0;
+#if defined( _WIN32 )
+	// no pread, serialize the seek + read
+	mutable std::mutex _mutex;
+	mutable std::ifstream _file;
+#else
+	int _fd = -1;
+#endif
+};
+}
+
+#endif
@@ -0,0 +1,406 @@
+//
+//  IndexCache.cpp
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#include "IndexCache.h"
+#include "FileMapping.h"
+#include "Utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <locale>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <thread>
+#if defined( _WIN32 )
+#	include <process.h>
+#else
+#	include <unistd.h>
+#endif
+
+namespace {
+
+const char kMagic[8] = {'p', 'd', 'f', 'p', 'i', 'd', 'x', '3'};
+const uint32_t kByteOrder = 0x01020304;
+//! FileHeader flags
+const uint32_t kPagesKnown = 1;
+
+struct FileHeader
+{
+	char magic[8];
+	uint32_t byteOrder;
+	uint32_t nbXRefs;
+	uint64_t size;
+	int64_t mtime;
+	uint64_t tailHash;
+	uint32_t nbLengths;
+	uint32_t nbPages;
+	uint32_t trailerSize;
+	uint32_t versionSize;
+	uint32_t flags;
+	uint32_t unused;
+	uint64_t checksum; //!< of the whole file, with this field at 0
+};
+struct LengthRecord
+{
+	uint64_t pos;
+	uint64_t len;
+};
+struct XRefRecord
+{
+	int32_t generationOrStreamID;
+	int32_t posOrIndex;
+	int32_t compressed;
+};
+struct PageRecord
+{
+	int32_t ref;
+	int32_t gen;
+};
+
+// records are laid out in that order, each stays aligned
+static_assert( sizeof( FileHeader ) % 8 == 0, "" );
+static_assert( sizeof( LengthRecord ) % 8 == 0, "" );
+static_assert( sizeof( XRefRecord ) % 4 == 0, "" );
+
+//! enough digits to read back the same float, in the "C" locale and
+//! without exponent, PDF has none
+void serializeReal( float i_value, std::string &o_out )
+{
+	std::ostringstream str;
+	str.imbue( std::locale::classic() );
+	str << std::setprecision( 9 ) << i_value;
+	auto res = str.str();
+	if ( res.find( 'e' ) != std::string::npos )
+	{
+		int exp10 = (int)std::floor( std::log10( std::fabs( i_value ) ) );
+		str.str( {} );
+		str << std::fixed << std::setprecision( std::max( 0, 8 - exp10 ) )
+		    << i_value;
+		res = str.str();
+	}
+	// still a real when read back
+	if ( res.find( '.' ) == std::string::npos )
+		res += ".0";
+	o_out += res;
+}
+
+void serialize( const pdfp::Object &i_obj, std::string &o_out )
+{
+	using pdfp::Object;
+	char buf[64];
+	switch ( i_obj.type() )
+	{
+		case Object::k_boolean:
+			o_out += i_obj.bool_value() ? "true" : "false";
+			break;
+		case Object::k_number:
+			if ( i_obj.is_int() )
+			{
+				snprintf( buf, sizeof( buf ), "%d", i_obj.int_value() );
+				o_out += buf;
+			}
+			else
+				serializeReal( i_obj.real_value(), o_out );
+			break;
+		case Object::k_name:
+			o_out += '/';
+			for ( uint8_t c : i_obj.name_value() )
+			{
+				if ( c <= 0x20 or c >= 0x7F or c == '#' or pdfp::isDelimiter( c ) )
+				{
+					snprintf( buf, sizeof( buf ), "#%02X", c );
+					o_out += buf;
+				}
+				else
+					o_out += char( c );
+			}
+			break;
+		case Object::k_string:
+			o_out += '<';
+			for ( uint8_t c : i_obj.string_value() )
+			{
+				snprintf( buf, sizeof( buf ), "%02X", c );
+				o_out += buf;
+			}
+			o_out += '>';
+			break;
+		case Object::k_array:
+			o_out += '[';
+			for ( auto &it : i_obj.array_items() )
+			{
+				serialize( it, o_out );
+				o_out += ' ';
+			}
+			o_out += ']';
+			break;
+		case Object::k_dictionary:
+			o_out += "<<";
+			for ( auto &it : i_obj.dictionary_items() )
+			{
+				serialize( Object::create_name( it.first.view() ), o_out );
+				o_out += ' ';
+				serialize( it.second, o_out );
+				o_out += ' ';
+			}
+			o_out += ">>";
+			break;
+		case Object::k_objectref:
+		{
+			auto ref = i_obj.ref_value();
+			snprintf( buf, sizeof( buf ), "%d %d R", ref.ref, (int)ref.gen );
+			o_out += buf;
+			break;
+		}
+		default:
+			// streams cannot be saved, they are not in a trailer anyway
+			o_out += "null";
+			break;
+	}
+}
+
+template <typename T>
+void append( std::string &o_out, const T &i_value )
+{
+	o_out.append( (const char *)&i_value, sizeof( T ) );
+}
+
+//! FNV-1a on 8 bytes words, a file is rejected if it does not match
+uint64_t checksum( const char *i_data, size_t i_len, uint64_t h )
+{
+	size_t i = 0;
+	for ( ; i + 8 <= i_len; i += 8 )
+	{
+		uint64_t w;
+		memcpy( &w, i_data + i, 8 );
+		h = ( h ^ w ) * 1099511628211ULL;
+	}
+	for ( ; i < i_len; ++i )
+		h = ( h ^ uint8_t( i_data[i] ) ) * 1099511628211ULL;
+	return h;
+}
+
+uint64_t checksum( FileHeader i_header, const char *i_body, size_t i_len )
+{
+	i_header.checksum = 0;
+	auto h = checksum(
+	    (const char *)&i_header, sizeof( FileHeader ), 14695981039346656037ULL );
+	return checksum( i_body, i_len, h );
+}
+
+//! unique to this process and thread, concurrent writers must not share
+//! a temporary file
+std::string temporaryPath( const std::string &i_path )
+{
+	static std::atomic<unsigned> counter{0};
+#if defined( _WIN32 )
+	auto pid = ::_getpid();
+#else
+	auto pid = ::getpid();
+#endif
+	return i_path + ".tmp" + std::to_string( pid ) + "-" +
+	       std::to_string(
+	           std::hash<std::thread::id>()( std::this_thread::get_id() ) ) +
+	       "-" + std::to_string( counter.fetch_add( 1 ) );
+}
+}
+
+namespace pdfp {
+
+int64_t IndexCache::modificationTime( const std::string &i_path )
+{
+#if defined( _WIN32 )
+	struct _stat64 st;
+	if ( ::_stat64( i_path.c_str(), &st ) != 0 )
+		return 0;
+#else
+	struct stat st;
+	if ( ::stat( i_path.c_str(), &st ) != 0 )
+		return 0;
+#endif
+	return (int64_t)st.st_mtime;
+}
+
+uint64_t IndexCache::hash( const uint8_t *i_data, size_t i_len )
+{
+	// FNV-1a
+	uint64_t h = 14695981039346656037ULL;
+	for ( size_t i = 0; i < i_len; ++i )
+	{
+		h ^= i_data[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+std::string IndexCache::serialize( const Object &i_obj )
+{
+	std::string out;
+	::serialize( i_obj, out );
+	return out;
+}
+
+bool IndexCache::read( const std::string &i_path,
+                       const Key &i_key,
+                       Content &o_content )
+{
+	FileMapping mapping;
+	std::string buffer;
+	const char *data = nullptr;
+	size_t size = 0;
+	if ( mapping.open( i_path ) )
+	{
+		data = mapping.data();
+		size = mapping.size();
+	}
+	else
+	{
+		std::ifstream file( i_path, std::ios_base::in | std::ios_base::binary );
+		if ( not file )
+			return false;
+		buffer.assign( std::istreambuf_iterator<char>( file ),
+		               std::istreambuf_iterator<char>() );
+		data = buffer.data();
+		size = buffer.size();
+	}
+
+	if ( size < sizeof( FileHeader ) )
+		return false;
+	FileHeader header;
+	memcpy( &header, data, sizeof( FileHeader ) );
+	if ( memcmp( header.magic, kMagic, sizeof( kMagic ) ) != 0 or
+	     header.byteOrder != kByteOrder or header.size != i_key.size or
+	     header.mtime != i_key.mtime or header.tailHash != i_key.tailHash )
+		return false;
+
+	size_t expected = sizeof( FileHeader ) +
+	                  ( header.nbLengths * sizeof( LengthRecord ) ) +
+	                  ( header.nbXRefs * sizeof( XRefRecord ) ) +
+	                  ( header.nbPages * sizeof( PageRecord ) ) +
+	                  header.trailerSize + header.versionSize;
+	if ( size != expected or
+	     header.checksum != checksum( header,
+	                                  data + sizeof( FileHeader ),
+	                                  size - sizeof( FileHeader ) ) )
+		return false;
+
+	auto ptr = data + sizeof( FileHeader );
+	auto lengths = (const LengthRecord *)ptr;
+	ptr += header.nbLengths * sizeof( LengthRecord );
+	auto xrefs = (const XRefRecord *)ptr;
+	ptr += header.nbXRefs * sizeof( XRefRecord );
+	auto pages = (const PageRecord *)ptr;
+	ptr += header.nbPages * sizeof( PageRecord );
+
+	o_content.recoveredLengths.clear();
+	o_content.recoveredLengths.reserve( header.nbLengths );
+	for ( uint32_t i = 0; i < header.nbLengths; ++i )
+		o_content.recoveredLengths.emplace_back( lengths[i].pos,
+		                                         lengths[i].len );
+
+	o_content.xrefs.clear();
+	o_content.xrefs.reserve( header.nbXRefs );
+	for ( uint32_t i = 0; i < header.nbXRefs; ++i )
+	{
+		if ( xrefs[i].compressed != 0 )
+			o_content.xrefs.emplace_back( xrefs[i].generationOrStreamID,
+			                              xrefs[i].posOrIndex,
+			                              true );
+		else
+			o_content.xrefs.emplace_back( xrefs[i].generationOrStreamID,
+			                              xrefs[i].posOrIndex );
+	}
+
+	o_content.pagesKnown = ( header.flags & kPagesKnown ) != 0;
+	o_content.pages.clear();
+	o_content.pages.reserve( header.nbPages );
+	for ( uint32_t i = 0; i < header.nbPages; ++i )
+	{
+		Object::ObjRef ref;
+		ref.ref = pages[i].ref;
+		ref.gen = (uint16_t)pages[i].gen;
+		o_content.pages.push_back( ref );
+	}
+
+	o_content.trailer.assign( ptr, header.trailerSize );
+	ptr += header.trailerSize;
+	o_content.version.assign( ptr, header.versionSize );
+	return true;
+}
+
+bool IndexCache::write( const std::string &i_path,
+                        const Key &i_key,
+                        const Content &i_content )
+{
+	FileHeader header{};
+	memcpy( header.magic, kMagic, sizeof( kMagic ) );
+	header.byteOrder = kByteOrder;
+	header.nbXRefs = (uint32_t)i_content.xrefs.size();
+	header.size = i_key.size;
+	header.mtime = i_key.mtime;
+	header.tailHash = i_key.tailHash;
+	header.nbLengths = (uint32_t)i_content.recoveredLengths.size();
+	header.nbPages = (uint32_t)i_content.pages.size();
+	header.trailerSize = (uint32_t)i_content.trailer.size();
+	header.versionSize = (uint32_t)i_content.version.size();
+	header.flags = i_content.pagesKnown ? kPagesKnown : 0;
+
+	std::string out;
+	out.reserve( sizeof( FileHeader ) +
+	             ( header.nbLengths * sizeof( LengthRecord ) ) +
+	             ( header.nbXRefs * sizeof( XRefRecord ) ) +
+	             ( header.nbPages * sizeof( PageRecord ) ) +
+	             header.trailerSize + header.versionSize );
+	append( out, header );
+	for ( auto &it : i_content.recoveredLengths )
+		append( out, LengthRecord{it.first, it.second} );
+	for ( auto &it : i_content.xrefs )
+		append( out,
+		        XRefRecord{it.generation(), it.pos(), it.compressed() ? 1 : 0} );
+	for ( auto &it : i_content.pages )
+		append( out, PageRecord{it.ref, it.gen} );
+	out += i_content.trailer;
+	out += i_content.version;
+	header.checksum = checksum( header,
+	                            out.data() + sizeof( FileHeader ),
+	                            out.size() - sizeof( FileHeader ) );
+	memcpy( &out[0], &header, sizeof( FileHeader ) );
+
+	// readers never see a partial file
+	auto tmpPath = temporaryPath( i_path );
+	std::ofstream file( tmpPath,
+	                    std::ios_base::out | std::ios_base::binary |
+	                        std::ios_base::trunc );
+	if ( file )
+	{
+		file.write( out.data(), out.size() );
+		// a full disk shows up when the last bytes are flushed
+		file.close();
+	}
+	if ( not file )
+	{
+		std::remove( tmpPath.c_str() );
+		return false;
+	}
+#if defined( _WIN32 )
+	std::remove( i_path.c_str() );
+#endif
+	if ( std::rename( tmpPath.c_str(), i_path.c_str() ) != 0 )
+	{
+		std::remove( tmpPath.c_str() );
+		return false;
+	}
+	return true;
+}
+}
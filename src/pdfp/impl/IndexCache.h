@@ -0,0 +1,74 @@
+//
+//  IndexCache.h
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#ifndef H_PDFP_IndexCache
+#define H_PDFP_IndexCache
+
+#include "XrefTable.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pdfp {
+
+/*!
+   @brief sidecar file with what open() parses before any object is read.
+
+       The xref entries, the trailer, the header version, the stream lengths
+   found by guessStreamLength() and the page objects. The file is a fixed
+   header followed by arrays of fixed size records, it is read in place
+   through a memory mapping and rejected unless its checksum matches.
+   Native byte order: it is a cache, not an exchange format.
+*/
+class IndexCache
+{
+public:
+	//! what must match for the cache to be used
+	struct Key
+	{
+		uint64_t size = 0;
+		int64_t mtime = 0;
+		uint64_t tailHash = 0; //!< the last bytes, startxref and usually the ID
+	};
+
+	struct Content
+	{
+		XRefVector_t xrefs;
+		std::string trailer; //!< the trailer dictionary, in PDF syntax
+		std::string version;
+		std::vector<std::pair<size_t, size_t>> recoveredLengths;
+		//! false if the page list was not built when written
+		bool pagesKnown = false;
+		//! empty when a page is a direct object
+		std::vector<Object::ObjRef> pages;
+	};
+
+	//! number of bytes of the end of the file in the key
+	static const size_t kTailSize = 1024;
+
+	//! modification time of a file, 0 if unknown
+	static int64_t modificationTime( const std::string &i_path );
+	static uint64_t hash( const uint8_t *i_data, size_t i_len );
+
+	//! the trailer dictionary in PDF syntax, only direct objects
+	static std::string serialize( const Object &i_obj );
+
+	//! false if the file is missing, invalid or for another key
+	static bool read( const std::string &i_path,
+	                  const Key &i_key,
+	                  Content &o_content );
+	//! write to a temporary file of this process and thread, then replace
+	//! i_path
+	static bool write( const std::string &i_path,
+	                   const Key &i_key,
+	                   const Content &i_content );
+};
+}
+
+#endif
@@ -0,0 +1,424 @@
+//
+//  Keywords.h
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#ifndef H_PDFP_Keywords
+#define H_PDFP_Keywords
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace pdfp {
+
+// clang-format off
+//! the standard names, one entry per distinct string: operators that are
+//! also keys (K, W, DP, ...) are listed once
+#define PDFP_KEYWORDS( X ) \
+	/* tokenizer keywords */ \
+	X( kw_true, "true" ) \
+	X( kw_false, "false" ) \
+	X( kw_null, "null" ) \
+	X( kw_obj, "obj" ) \
+	X( kw_endobj, "endobj" ) \
+	X( kw_stream, "stream" ) \
+	X( kw_endstream, "endstream" ) \
+	X( kw_xref, "xref" ) \
+	X( kw_trailer, "trailer" ) \
+	X( kw_startxref, "startxref" ) \
+	X( kw_R, "R" ) \
+	/* filters */ \
+	X( kw_FlateDecode, "FlateDecode" ) \
+	X( kw_Fl, "Fl" ) \
+	X( kw_LZWDecode, "LZWDecode" ) \
+	X( kw_LZW, "LZW" ) \
+	X( kw_ASCIIHexDecode, "ASCIIHexDecode" ) \
+	X( kw_AHx, "AHx" ) \
+	X( kw_ASCII85Decode, "ASCII85Decode" ) \
+	X( kw_A85, "A85" ) \
+	X( kw_RunLengthDecode, "RunLengthDecode" ) \
+	X( kw_RL, "RL" ) \
+	X( kw_CCITTFaxDecode, "CCITTFaxDecode" ) \
+	X( kw_CCF, "CCF" ) \
+	X( kw_DCTDecode, "DCTDecode" ) \
+	X( kw_DCT, "DCT" ) \
+	X( kw_JPXDecode, "JPXDecode" ) \
+	X( kw_JBIG2Decode, "JBIG2Decode" ) \
+	X( kw_Crypt, "Crypt" ) \
+	/* dictionary keys and values */ \
+	X( kw_Type, "Type" ) \
+	X( kw_Subtype, "Subtype" ) \
+	X( kw_Length, "Length" ) \
+	X( kw_Filter, "Filter" ) \
+	X( kw_DecodeParms, "DecodeParms" ) \
+	X( kw_DP, "DP" ) \
+	X( kw_Parent, "Parent" ) \
+	X( kw_Kids, "Kids" ) \
+	X( kw_Count, "Count" ) \
+	X( kw_Page, "Page" ) \
+	X( kw_Pages, "Pages" ) \
+	X( kw_Resources, "Resources" ) \
+	X( kw_Contents, "Contents" ) \
+	X( kw_MediaBox, "MediaBox" ) \
+	X( kw_CropBox, "CropBox" ) \
+	X( kw_BleedBox, "BleedBox" ) \
+	X( kw_TrimBox, "TrimBox" ) \
+	X( kw_ArtBox, "ArtBox" ) \
+	X( kw_Rotate, "Rotate" ) \
+	X( kw_Font, "Font" ) \
+	X( kw_XObject, "XObject" ) \
+	X( kw_ExtGState, "ExtGState" ) \
+	X( kw_ColorSpace, "ColorSpace" ) \
+	X( kw_Pattern, "Pattern" ) \
+	X( kw_Shading, "Shading" ) \
+	X( kw_ProcSet, "ProcSet" ) \
+	X( kw_Properties, "Properties" ) \
+	X( kw_Width, "Width" ) \
+	X( kw_Height, "Height" ) \
+	X( kw_BitsPerComponent, "BitsPerComponent" ) \
+	X( kw_ImageMask, "ImageMask" ) \
+	X( kw_Mask, "Mask" ) \
+	X( kw_SMask, "SMask" ) \
+	X( kw_Decode, "Decode" ) \
+	X( kw_Interpolate, "Interpolate" ) \
+	X( kw_Name, "Name" ) \
+	X( kw_BaseFont, "BaseFont" ) \
+	X( kw_FirstChar, "FirstChar" ) \
+	X( kw_LastChar, "LastChar" ) \
+	X( kw_Widths, "Widths" ) \
+	X( kw_FontDescriptor, "FontDescriptor" ) \
+	X( kw_Encoding, "Encoding" ) \
+	X( kw_ToUnicode, "ToUnicode" ) \
+	X( kw_DescendantFonts, "DescendantFonts" ) \
+	X( kw_CIDSystemInfo, "CIDSystemInfo" ) \
+	X( kw_FontFile, "FontFile" ) \
+	X( kw_FontFile2, "FontFile2" ) \
+	X( kw_FontFile3, "FontFile3" ) \
+	X( kw_FontName, "FontName" ) \
+	X( kw_Flags, "Flags" ) \
+	X( kw_FontBBox, "FontBBox" ) \
+	X( kw_ItalicAngle, "ItalicAngle" ) \
+	X( kw_Ascent, "Ascent" ) \
+	X( kw_Descent, "Descent" ) \
+	X( kw_CapHeight, "CapHeight" ) \
+	X( kw_StemV, "StemV" ) \
+	X( kw_XHeight, "XHeight" ) \
+	X( kw_Root, "Root" ) \
+	X( kw_Info, "Info" ) \
+	X( kw_ID, "ID" ) \
+	X( kw_Size, "Size" ) \
+	X( kw_Prev, "Prev" ) \
+	X( kw_Index, "Index" ) \
+	X( kw_W, "W" ) \
+	X( kw_XRefStm, "XRefStm" ) \
+	X( kw_Encrypt, "Encrypt" ) \
+	X( kw_N, "N" ) \
+	X( kw_First, "First" ) \
+	X( kw_Extends, "Extends" ) \
+	X( kw_ObjStm, "ObjStm" ) \
+	X( kw_XRef, "XRef" ) \
+	X( kw_Catalog, "Catalog" ) \
+	X( kw_Predictor, "Predictor" ) \
+	X( kw_Colors, "Colors" ) \
+	X( kw_Columns, "Columns" ) \
+	X( kw_K, "K" ) \
+	X( kw_EndOfLine, "EndOfLine" ) \
+	X( kw_EncodedByteAlign, "EncodedByteAlign" ) \
+	X( kw_Rows, "Rows" ) \
+	X( kw_EndOfBlock, "EndOfBlock" ) \
+	X( kw_BlackIs1, "BlackIs1" ) \
+	X( kw_DamagedRowsBeforeError, "DamagedRowsBeforeError" ) \
+	X( kw_EarlyChange, "EarlyChange" ) \
+	X( kw_JBIG2Globals, "JBIG2Globals" ) \
+	X( kw_Metadata, "Metadata" ) \
+	X( kw_Annots, "Annots" ) \
+	X( kw_Outlines, "Outlines" ) \
+	X( kw_Names, "Names" ) \
+	X( kw_Dests, "Dests" ) \
+	X( kw_Version, "Version" ) \
+	X( kw_Alternate, "Alternate" ) \
+	X( kw_Matrix, "Matrix" ) \
+	X( kw_BBox, "BBox" ) \
+	X( kw_FormType, "FormType" ) \
+	X( kw_Group, "Group" ) \
+	X( kw_Form, "Form" ) \
+	X( kw_Image, "Image" ) \
+	X( kw_S, "S" ) \
+	X( kw_CFM, "CFM" ) \
+	X( kw_AuthEvent, "AuthEvent" ) \
+	X( kw_CF, "CF" ) \
+	X( kw_StmF, "StmF" ) \
+	X( kw_StrF, "StrF" ) \
+	X( kw_EncryptMetadata, "EncryptMetadata" ) \
+	X( kw_O, "O" ) \
+	X( kw_U, "U" ) \
+	X( kw_P, "P" ) \
+	X( kw_V, "V" ) \
+	X( kw_Lang, "Lang" ) \
+	X( kw_MarkInfo, "MarkInfo" ) \
+	X( kw_StructTreeRoot, "StructTreeRoot" ) \
+	X( kw_StructParents, "StructParents" ) \
+	X( kw_Tabs, "Tabs" ) \
+	X( kw_Range, "Range" ) \
+	X( kw_Domain, "Domain" ) \
+	X( kw_FunctionType, "FunctionType" ) \
+	X( kw_Functions, "Functions" ) \
+	X( kw_Bounds, "Bounds" ) \
+	X( kw_C0, "C0" ) \
+	X( kw_C1, "C1" ) \
+	X( kw_BM, "BM" ) \
+	X( kw_CA, "CA" ) \
+	X( kw_ca, "ca" ) \
+	X( kw_LW, "LW" ) \
+	X( kw_LC, "LC" ) \
+	X( kw_LJ, "LJ" ) \
+	X( kw_ML, "ML" ) \
+	X( kw_D, "D" ) \
+	X( kw_RI, "RI" ) \
+	X( kw_SA, "SA" ) \
+	X( kw_TK, "TK" ) \
+	X( kw_UserUnit, "UserUnit" ) \
+	X( kw_Annot, "Annot" ) \
+	X( kw_Rect, "Rect" ) \
+	X( kw_Border, "Border" ) \
+	X( kw_F, "F" ) \
+	X( kw_A, "A" ) \
+	X( kw_Dest, "Dest" ) \
+	X( kw_URI, "URI" ) \
+	X( kw_Widget, "Widget" ) \
+	X( kw_Link, "Link" ) \
+	X( kw_Type0, "Type0" ) \
+	X( kw_Type1, "Type1" ) \
+	X( kw_Type3, "Type3" ) \
+	X( kw_TrueType, "TrueType" ) \
+	X( kw_CIDFontType0, "CIDFontType0" ) \
+	X( kw_CIDFontType2, "CIDFontType2" ) \
+	X( kw_Identity, "Identity" ) \
+	X( kw_None, "None" ) \
+	X( kw_DocOpen, "DocOpen" ) \
+	X( kw_DeviceGray, "DeviceGray" ) \
+	X( kw_DeviceRGB, "DeviceRGB" ) \
+	X( kw_DeviceCMYK, "DeviceCMYK" ) \
+	X( kw_ICCBased, "ICCBased" ) \
+	X( kw_Indexed, "Indexed" ) \
+	X( kw_Separation, "Separation" ) \
+	X( kw_DeviceN, "DeviceN" ) \
+	X( kw_CalRGB, "CalRGB" ) \
+	X( kw_CalGray, "CalGray" ) \
+	X( kw_Lab, "Lab" ) \
+	/* content stream operators */ \
+	X( kw_b, "b" ) \
+	X( kw_B, "B" ) \
+	X( kw_bStar, "b*" ) \
+	X( kw_BStar, "B*" ) \
+	X( kw_BDC, "BDC" ) \
+	X( kw_BI, "BI" ) \
+	X( kw_BMC, "BMC" ) \
+	X( kw_BT, "BT" ) \
+	X( kw_BX, "BX" ) \
+	X( kw_c, "c" ) \
+	X( kw_cm, "cm" ) \
+	X( kw_CS, "CS" ) \
+	X( kw_cs, "cs" ) \
+	X( kw_d, "d" ) \
+	X( kw_d0, "d0" ) \
+	X( kw_d1, "d1" ) \
+	X( kw_Do, "Do" ) \
+	X( kw_EI, "EI" ) \
+	X( kw_EMC, "EMC" ) \
+	X( kw_ET, "ET" ) \
+	X( kw_EX, "EX" ) \
+	X( kw_f, "f" ) \
+	X( kw_fStar, "f*" ) \
+	X( kw_G, "G" ) \
+	X( kw_g, "g" ) \
+	X( kw_gs, "gs" ) \
+	X( kw_h, "h" ) \
+	X( kw_i, "i" ) \
+	X( kw_j, "j" ) \
+	X( kw_J, "J" ) \
+	X( kw_k, "k" ) \
+	X( kw_l, "l" ) \
+	X( kw_m, "m" ) \
+	X( kw_M, "M" ) \
+	X( kw_MP, "MP" ) \
+	X( kw_n, "n" ) \
+	X( kw_q, "q" ) \
+	X( kw_Q, "Q" ) \
+	X( kw_re, "re" ) \
+	X( kw_RG, "RG" ) \
+	X( kw_rg, "rg" ) \
+	X( kw_ri, "ri" ) \
+	X( kw_s, "s" ) \
+	X( kw_SC, "SC" ) \
+	X( kw_sc, "sc" ) \
+	X( kw_SCN, "SCN" ) \
+	X( kw_scn, "scn" ) \
+	X( kw_sh, "sh" ) \
+	X( kw_TStar, "T*" ) \
+	X( kw_Tc, "Tc" ) \
+	X( kw_Td, "Td" ) \
+	X( kw_TD, "TD" ) \
+	X( kw_Tf, "Tf" ) \
+	X( kw_Tj, "Tj" ) \
+	X( kw_TJ, "TJ" ) \
+	X( kw_TL, "TL" ) \
+	X( kw_Tm, "Tm" ) \
+	X( kw_Tr, "Tr" ) \
+	X( kw_Ts, "Ts" ) \
+	X( kw_Tw, "Tw" ) \
+	X( kw_Tz, "Tz" ) \
+	X( kw_v, "v" ) \
+	X( kw_w, "w" ) \
+	X( kw_WStar, "W*" ) \
+	X( kw_y, "y" ) \
+	X( kw_Quote, "'" ) \
+	X( kw_DoubleQuote, "\"" )
+
+// clang-format on
+
+/*!
+   @brief a well-known PDF keyword, filter, key or operator.
+
+       kw_none for any other string.
+*/
+enum class Keyword : uint16_t
+{
+	kw_none,
+#define PDFP_KEYWORD_ENUM( id, str ) id,
+	PDFP_KEYWORDS( PDFP_KEYWORD_ENUM )
+#undef PDFP_KEYWORD_ENUM
+};
+
+namespace details {
+
+inline constexpr std::string_view kKeywordNames[] = {
+    "",
+#define PDFP_KEYWORD_NAME( id, str ) str,
+    PDFP_KEYWORDS( PDFP_KEYWORD_NAME )
+#undef PDFP_KEYWORD_NAME
+};
+inline constexpr size_t kNbKeywords =
+    sizeof( kKeywordNames ) / sizeof( kKeywordNames[0] );
+
+// the perfect hash: a first hash picks a bucket, each bucket has its own
+// seed that sends all its strings to free slots
+inline constexpr size_t kKeywordBuckets = 128;
+inline constexpr size_t kKeywordSlots = 512;
+
+constexpr uint64_t hashKeyword( const std::string_view &i_str )
+{
+	// FNV-1a
+	uint64_t h = 0xcbf29ce484222325ULL;
+	for ( char c : i_str )
+	{
+		h ^= uint8_t( c );
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+constexpr size_t keywordSlot( uint64_t i_hash, uint32_t i_seed )
+{
+	// murmur3 finalizer
+	uint32_t h = uint32_t( i_hash >> 32 ) ^ ( i_seed * 0x9e3779b9u );
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h % kKeywordSlots;
+}
+
+struct KeywordTable
+{
+	std::array<uint16_t, kKeywordBuckets> seeds{};
+	std::array<uint16_t, kKeywordSlots> slots{}; //!< Keyword, kw_none if free
+	bool valid = false;
+};
+
+constexpr KeywordTable makeKeywordTable()
+{
+	KeywordTable table;
+
+	// the keywords grouped by bucket
+	std::array<uint64_t, kNbKeywords> hashes{};
+	std::array<size_t, kKeywordBuckets + 1> starts{};
+	for ( size_t i = 1; i < kNbKeywords; ++i )
+	{
+		hashes[i] = hashKeyword( kKeywordNames[i] );
+		++starts[( hashes[i] % kKeywordBuckets ) + 1];
+	}
+	for ( size_t b = 0; b < kKeywordBuckets; ++b )
+		starts[b + 1] += starts[b];
+	std::array<uint16_t, kNbKeywords> members{};
+	std::array<size_t, kKeywordBuckets> fill{};
+	for ( size_t i = 1; i < kNbKeywords; ++i )
+	{
+		auto b = hashes[i] % kKeywordBuckets;
+		members[starts[b] + fill[b]++] = uint16_t( i );
+	}
+
+	// biggest buckets first, while there is still room
+	size_t biggest = 0;
+	for ( auto size : fill )
+		biggest = size > biggest ? size : biggest;
+	for ( size_t n = kKeywordBuckets * biggest; n-- > 0; )
+	{
+		size_t b = n % kKeywordBuckets;
+		if ( fill[b] != ( n / kKeywordBuckets ) + 1 )
+			continue;
+
+		bool placed = false;
+		for ( uint32_t seed = 0; seed < 0xffff and not placed; ++seed )
+		{
+			size_t m = starts[b];
+			for ( ; m < starts[b + 1]; ++m )
+			{
+				auto s = keywordSlot( hashes[members[m]], seed );
+				if ( table.slots[s] != 0 )
+					break;
+				table.slots[s] = members[m];
+			}
+			placed = m == starts[b + 1];
+			if ( placed )
+				table.seeds[b] = uint16_t( seed );
+			else
+			{
+				// undo
+				while ( m-- > starts[b] )
+					table.slots[keywordSlot( hashes[members[m]], seed )] = 0;
+			}
+		}
+		if ( not placed )
+			return table;
+	}
+	table.valid = true;
+	return table;
+}
+
+inline constexpr KeywordTable kKeywordTable = makeKeywordTable();
+static_assert( kKeywordTable.valid, "no perfect hash for the keywords" );
+}
+
+//! classify a string with one hash and one compare
+constexpr Keyword keyword( const std::string_view &i_str )
+{
+	auto h = details::hashKeyword( i_str );
+	auto seed = details::kKeywordTable.seeds[h % details::kKeywordBuckets];
+	auto k = details::kKeywordTable.slots[details::keywordSlot( h, seed )];
+	return details::kKeywordNames[k] == i_str ? Keyword( k ) : Keyword::kw_none;
+}
+
+//! the string of a keyword
+constexpr std::string_view keywordName( Keyword i_keyword )
+{
+	return details::kKeywordNames[size_t( i_keyword )];
+}
+}
+
+#endif
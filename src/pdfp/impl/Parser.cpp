@@ -10,13 +10,13 @@
 #include "Parser.h"
 #include "pdfp/PDFDocument.h"
 #include "su/containers/flat_set.h"
-#include "su/containers/stackarray.h"
 #include "su/log/logger.h"
-#include "su/streams/membuf.h"
 #include "Utils.h"
+#include "XRefScanner.h"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <unordered_set>
-#include <array>
 
 namespace {
 bool ArrayToVectorOfInt( const pdfp::Object &i_array,
@@ -57,73 +57,116 @@ bool ArrayToVectorOfRange( const pdfp::Object &i_array,
 	return true;
 }
 
-bool isHeaderLine( const std::string &i_line, std::string &o_headerVersion )
+//! key of a cross reference stream W array, for the specialized kernels
+constexpr int xrefLayout( int i_w0, int i_w1, int i_w2 )
 {
-	auto p = i_line.find( "%PDF-" );
-	if ( p != std::string::npos )
+	if ( i_w0 > 9 or i_w1 > 9 or i_w2 > 9 )
+		return -1;
+	return ( i_w0 * 100 ) + ( i_w1 * 10 ) + i_w2;
+}
+
+//! big endian field of a cross reference stream entry
+template <int N>
+inline int xrefField( const uint8_t *i_ptr )
+{
+	uint32_t v = 0;
+	for ( int k = 0; k < N; ++k )
+		v = ( v << 8 ) | i_ptr[k];
+	return (int)v;
+}
+
+/*!
+   @brief decode the entries of a cross reference stream subsection.
+
+       Specialized on the width of the 3 fields, the common layouts become
+   straight loads.
+   @param io_ptr decoded stream data, moved past the entries read
+   @param i_count number of entries in the subsection
+   @param i_entry called with the index in the subsection and the 3 fields
+*/
+template <int W0, int W1, int W2, typename F>
+void decodeXRefStream( const uint8_t *&io_ptr,
+                       const uint8_t *i_end,
+                       size_t i_count,
+                       F &i_entry )
+{
+	constexpr size_t kWidth = W0 + W1 + W2;
+	size_t nb = std::min( i_count, size_t( i_end - io_ptr ) / kWidth );
+	for ( size_t i = 0; i < nb; ++i, io_ptr += kWidth )
 	{
-		if ( i_line.size() >= ( p + 8 ) and isdigit( i_line[p + 5] ) )
+		i_entry( i,
+		         xrefField<W0>( io_ptr ),
+		         xrefField<W1>( io_ptr + W0 ),
+		         xrefField<W2>( io_ptr + W0 + W1 ) );
+	}
+	// a truncated entry ends the data
+	if ( nb < i_count )
+		io_ptr = i_end;
+}
+
+//! any other layout, the missing fields are 0
+template <typename F>
+void decodeXRefStream( const std::vector<int> &i_w,
+                       const uint8_t *&io_ptr,
+                       const uint8_t *i_end,
+                       size_t i_count,
+                       F &i_entry )
+{
+	size_t width = 0;
+	for ( auto &it : i_w )
+		width += it;
+	if ( width == 0 )
+		return;
+	size_t nb = std::min( i_count, size_t( i_end - io_ptr ) / width );
+	for ( size_t i = 0; i < nb; ++i )
+	{
+		uint32_t fields[3] = {0, 0, 0};
+		for ( size_t j = 0; j < i_w.size(); ++j )
 		{
-			o_headerVersion = i_line.substr( p + 5 );
-			return true;
+			uint32_t v = 0;
+			for ( int k = 0; k < i_w[j]; ++k )
+				v = ( v << 8 ) | *io_ptr++;
+			if ( j < 3 )
+				fields[j] = v;
 		}
+		i_entry( i, (int)fields[0], (int)fields[1], (int)fields[2] );
 	}
-	return false;
+	if ( nb < i_count )
+		io_ptr = i_end;
 }
 
-bool isObjDef( const std::string &i_line, int &num, int &gen )
+//! parse a classic xref entry, false if it is not exactly
+//! "nnnnnnnnnn ggggg n" followed by 2 white spaces
+bool parseXRefEntry( const char *i_entry,
+                     size_t &o_pos,
+                     int &o_gen,
+                     bool &o_used )
 {
-	// search for ^\s*\d+\s+\d+\s+obj
-
-	auto ptr = i_line.begin();
-
-	// skip spaces
-	while ( ptr != i_line.end() and std::isspace( *ptr ) )
-		++ptr;
-
-	// read int
-	if ( ptr == i_line.end() or not std::isdigit( *ptr ) )
-		return false;
-
-	num = 0;
-	while ( ptr != i_line.end() and std::isdigit( *ptr ) )
-		num = ( num * 10 ) + ( *ptr++ - '0' );
-
-	if ( ptr == i_line.end() or not std::isspace( *ptr ) )
-		return false;
-
-	// skip spaces
-	while ( ptr != i_line.end() and std::isspace( *ptr ) )
-		++ptr;
-
-	// read int
-	if ( ptr == i_line.end() or not std::isdigit( *ptr ) )
-		return false;
-
-	gen = 0;
-	while ( ptr != i_line.end() and std::isdigit( *ptr ) )
-		gen = ( gen * 10 ) + ( *ptr++ - '0' );
-
-	if ( ptr == i_line.end() or not std::isspace( *ptr ) )
-		return false;
-
-	// skip spaces
-	while ( ptr != i_line.end() and std::isspace( *ptr ) )
-		++ptr;
-
-	// read obj
-	if ( ptr == i_line.end() or *ptr != 'o' )
-		return false;
-	++ptr;
-	if ( ptr == i_line.end() or *ptr != 'b' )
+	auto isDigit = []( char c ) { return unsigned( c - '0' ) <= 9; };
+	uint64_t pos = 0;
+	for ( int i = 0; i < 10; ++i )
+	{
+		if ( not isDigit( i_entry[i] ) )
+			return false;
+		pos = ( pos * 10 ) + ( i_entry[i] - '0' );
+	}
+	if ( i_entry[10] != ' ' )
 		return false;
-	++ptr;
-	if ( ptr == i_line.end() or *ptr != 'j' )
+	int gen = 0;
+	for ( int i = 11; i < 16; ++i )
+	{
+		if ( not isDigit( i_entry[i] ) )
+			return false;
+		gen = ( gen * 10 ) + ( i_entry[i] - '0' );
+	}
+	if ( i_entry[16] != ' ' or ( i_entry[17] != 'n' and i_entry[17] != 'f' ) or
+	     not pdfp::isWhiteSpace( i_entry[18] ) or
+	     not pdfp::isWhiteSpace( i_entry[19] ) )
 		return false;
-	++ptr;
-
-	return ptr == i_line.end() or pdfp::isWhiteSpace( *ptr ) or
-	       pdfp::isDelimiter( *ptr );
+	o_pos = (size_t)pos;
+	o_gen = gen;
+	o_used = i_entry[17] == 'n';
+	return true;
 }
 }
 
@@ -135,9 +178,16 @@ Parser::Parser( std::istream &i_str, Document *i_doc ) :
 {
 }
 
+Parser::Parser( const char *i_begin, const char *i_end, Document *i_doc ) :
+    _doc( i_doc ),
+    _tokenizer( i_begin, i_end )
+{
+}
+
 void Parser::cleanup()
 {
-	_compressedObjects.clear();
+	_objectStreams.clear();
+	_lastObjectStreamData = {};
 }
 
 Object Parser::readXRef( std::string &o_headerVersion )
@@ -226,7 +276,7 @@ Object Parser::readXRef( std::string &o_headerVersion )
 			auto &xrefStm = it->second;
 			if ( xrefStm.is_number() )
 				xrefposStack.push( xrefStm.int_value() );
-			trailerDict.erase( "XRefStm" );
+			trailerDict.erase( it );
 		}
 	}
 
@@ -262,16 +312,16 @@ bool Parser::verifyXRef()
 	return true;
 }
 
-void transfer( const Object::dictionary &src, Object::dictionary &dst )
+void transfer( Object::dictionary_range src, Object::dictionary &dst )
 {
 	for ( auto &it : src )
 		dst[it.first] = it.second;
 }
 
 void transferIfNotAlreadyThere(
-    const Object::dictionary &src,
+    Object::dictionary_range src,
     Object::dictionary &dst,
-    const std::unordered_set<std::string> &i_filter )
+    const std::unordered_set<std::string_view> &i_filter )
 {
 	for ( auto &it : src )
 	{
@@ -285,86 +335,74 @@ void transferIfNotAlreadyThere(
 
 Object Parser::buildXRef( std::string &o_headerVersion )
 {
-	//! @todo: optimise, getLine is very slow
-
-	_tokenizer.seekg( 0, std::ios_base::beg );
 	o_headerVersion.clear();
 
-	Object::dictionary trailerDict;
-
-#if 0
-	std::array<char,4096> buffer;
-	std::streamoff bufferStart = 0;
-	std::streamoff pos = buffer.size();
-
-	while ( _tokenizer )
+	XRefScanner scanner;
+	auto memory = _tokenizer.memory();
+	if ( memory.data() != nullptr )
+		scanner.scan( memory.data(), memory.data() + memory.size(), 0 );
+	else
 	{
-		// fill buffer
-		std::streamoff bufSize;
-		
-		if ( bufferStart == 0 )
-		{
-			bufSize = _tokenizer.read( buffer.data(), buffer.size() );
-			// check for '%PDF-'
-			assert( false );
-		}
-		else
-		{
-			assert( false );
-		}
-		pos = 0;
-
-		// look for:
-		//	1- \sobj[white space or delim]
-		//  2- \strailer[white space or delim]
-		while ( pos < bufSize )
+		// scan blocks of complete lines
+		const size_t kScanBlockSize = 16 * 1024 * 1024;
+		std::vector<char> block( kScanBlockSize );
+		size_t blockPos = 0, used = 0;
+		_tokenizer.seekg( 0, std::ios_base::beg );
+		for ( ;; )
 		{
-			if ( isInterresting( buffer[pos] ) )
+			size_t toRead = block.size() - used;
+			auto len = _tokenizer.read( block.data() + used, toRead );
+			if ( len > 0 )
+				used += len;
+			bool atEnd = len <= 0 or size_t( len ) < toRead;
+
+			size_t cut = used;
+			if ( not atEnd )
 			{
-				assert( false );
+				while ( cut > 0 and block[cut - 1] != '\n' and
+				        block[cut - 1] != '\r' )
+					--cut;
+				if ( cut == 0 )
+				{
+					// a very long line
+					block.resize( block.size() * 2 );
+					continue;
+				}
 			}
-			else
-				pos += 5;
+			scanner.scan( block.data(), block.data() + cut, blockPos );
+			if ( atEnd )
+				break;
+			memmove( block.data(), block.data() + cut, used - cut );
+			blockPos += cut;
+			used -= cut;
 		}
 	}
-#else
-	std::string line;
-	line.reserve( 1024 );
-	std::streamoff pos = 0;
 
-	while ( _tokenizer.getLine( line ) )
+	// in file order, keep the highest generation, the last one if equal
+	for ( auto &it : scanner.objects() )
 	{
-		if ( line.compare( 0, 7, "trailer" ) == 0 )
-		{
-			//	read trailer
-			_tokenizer.seekg( pos + 7, std::ios::beg );
-			try
-			{
-				auto obj = readObject_priv( 0, 0 );
-				transfer( obj.dictionary_items(), trailerDict );
-			}
-			catch ( ... )
-			{}
-		}
-		else
-		{
-			int num, gen;
-			if ( isObjDef( line, num, gen ) )
-			{
-				// make room in the xref table
-				_doc->xrefTable().expand( num + 1 );
+		// make room in the xref table
+		_doc->xrefTable().expand( it.num + 1 );
 
-				int currentGen = _doc->xrefTable()[num].generation();
-				if ( currentGen == -1 or currentGen <= gen )
-					_doc->xrefTable()[num] = XRef( gen, (int)pos );
-			}
-			else if ( isHeaderLine( line, o_headerVersion ) )
-			{
-			}
+		int currentGen = _doc->xrefTable()[it.num].generation();
+		if ( currentGen == -1 or currentGen <= it.gen )
+			_doc->xrefTable()[it.num] = XRef( it.gen, (int)it.pos );
+	}
+	o_headerVersion = scanner.headerVersion();
+
+	Object::dictionary trailerDict;
+	for ( auto pos : scanner.trailers() )
+	{
+		//	read trailer
+		_tokenizer.seekg( pos, std::ios::beg );
+		try
+		{
+			auto obj = readObject_priv( 0, 0 );
+			transfer( obj.dictionary_items(), trailerDict );
 		}
-		pos = _tokenizer.tellg();
+		catch ( ... )
+		{}
 	}
-#endif
 
 	auto it = trailerDict.find( "XRefStm" );
 	if ( it != trailerDict.end() and not it->second.is_null() )
@@ -399,27 +437,18 @@ void Parser::readCrossReferenceTable( Object::dictionary &o_trailerDict,
 		// make room if our xref table is too small
 		_doc->xrefTable().expand( objRefNb + nbOfObj );
 
-		// for each entry
-		for ( int i = objRefNb; i < ( objRefNb + nbOfObj ); ++i )
+		// for each entry, the well formed ones first, then the tokenizer for
+		// the rest
+		int i = objRefNb + (int)readFixedXRefEntries( objRefNb, nbOfObj );
+		for ( ; i < ( objRefNb + nbOfObj ); ++i )
 		{
 			_tokenizer.nextTokenForced( token, Token::tok_int );
 			_tokenizer.nextTokenForced( token2, Token::tok_int );
 			_tokenizer.nextTokenForced( token3, Token::tok_command );
 			if ( token3.value() == "n" )
-			{
-				size_t pos = token.intValue();
-				int gen = token2.intValue();
-				int currentGen = _doc->xrefTable()[i].generation();
-				if ( currentGen == -1 or ( gen != 65535 and currentGen < gen ) )
-					_doc->xrefTable()[i] = XRef( gen, (int)pos );
-			}
+				setXRefEntry( i, token.intValue(), token2.intValue(), true );
 			else if ( token3.value() == "f" )
-			{
-				int gen = token2.intValue();
-				int currentGen = _doc->xrefTable()[i].generation();
-				if ( currentGen == -1 or ( gen != 65535 and currentGen < gen ) )
-					_doc->xrefTable()[i] = XRef( gen, -1 );
-			}
+				setXRefEntry( i, 0, token2.intValue(), false );
 			else
 				_tokenizer.invalidToken( token3 );
 		}
@@ -440,6 +469,83 @@ void Parser::readCrossReferenceTable( Object::dictionary &o_trailerDict,
 	}
 }
 
+void Parser::setXRefEntry( int i_id, size_t i_pos, int i_gen, bool i_used )
+{
+	int currentGen = _doc->xrefTable()[i_id].generation();
+	if ( currentGen == -1 or ( i_gen != 65535 and currentGen < i_gen ) )
+		_doc->xrefTable()[i_id] = XRef( i_gen, i_used ? (int)i_pos : -1 );
+}
+
+size_t Parser::readFixedXRefEntries( int i_first, int i_count )
+{
+	// "nnnnnnnnnn ggggg n" and a 2 characters eol
+	const size_t kEntrySize = 20;
+	const size_t kMaxEntriesPerRead = 64 * 1024;
+
+	auto start = _tokenizer.tellg();
+	if ( start < 0 or i_count <= 0 )
+		return 0;
+
+	// parse as many entries as possible, return the number of bytes used
+	size_t nb = 0;
+	auto parse = [&]( const char *i_ptr, const char *i_end, size_t i_max ) {
+		auto ptr = i_ptr;
+		size_t pos;
+		int gen;
+		bool used;
+		while ( i_max > 0 and size_t( i_end - ptr ) >= kEntrySize and
+		        parseXRefEntry( ptr, pos, gen, used ) )
+		{
+			setXRefEntry( i_first + (int)nb, pos, gen, used );
+			ptr += kEntrySize;
+			++nb;
+			--i_max;
+		}
+		return size_t( ptr - i_ptr );
+	};
+
+	size_t consumed = 0;
+	auto memory = _tokenizer.memory();
+	if ( memory.data() != nullptr )
+	{
+		auto ptr = skipWhiteSpace( memory.data() + start,
+		                           memory.data() + memory.size() );
+		consumed = ptr - ( memory.data() + start );
+		consumed += parse( ptr, memory.data() + memory.size(), i_count );
+	}
+	else
+	{
+		// in blocks, the first one with room for the eol of the header
+		std::vector<char> buffer;
+		bool first = true;
+		while ( nb < size_t( i_count ) )
+		{
+			size_t toRead =
+			    std::min( size_t( i_count ) - nb, kMaxEntriesPerRead );
+			buffer.resize( ( toRead * kEntrySize ) + ( first ? 16 : 0 ) );
+			_tokenizer.seekg( start + consumed, std::ios_base::beg );
+			auto len = _tokenizer.read( buffer.data(), buffer.size() );
+			if ( len <= 0 )
+				break;
+			const char *ptr = buffer.data();
+			if ( first )
+			{
+				ptr = skipWhiteSpace( ptr, ptr + len );
+				consumed += ptr - buffer.data();
+				first = false;
+			}
+			size_t before = nb;
+			consumed += parse( ptr, buffer.data() + len, toRead );
+			if ( ( nb - before ) != toRead )
+				break;
+		}
+	}
+
+	// the tokenizer continue after the last good entry
+	_tokenizer.seekg( start + consumed, std::ios_base::beg );
+	return nb;
+}
+
 void Parser::readCrossReferenceStream( Object::dictionary &o_trailerDict,
                                        std::streamoff &o_xrefpos )
 {
@@ -484,36 +590,23 @@ void Parser::readCrossReferenceStream( Object::dictionary &o_trailerDict,
 	if ( not ArrayToVectorOfInt( W, w ) )
 		throw std::runtime_error( "invalid cross reference stream" );
 
-	auto data = streamObj.stream_data();
-
-	size_t fieldsWidth = 0;
 	for ( auto &it : w )
-		fieldsWidth += it;
-
-	su::stackarray<int, 4> fields( w.size() );
-	su::stackarray<uint8_t, 16> buffer( fieldsWidth );
-	for ( auto &range : index ) // for each range
 	{
-		for ( int i = range.objNb; i < range.objNb + range.nbOfEntry;
-		      ++i ) // for each id in the range
-		{
-			if ( data->read( {buffer.data(), fieldsWidth} ) != fieldsWidth )
-				break;
-			uint8_t *ptr = buffer.data();
+		if ( it < 0 )
+			throw std::runtime_error( "invalid cross reference stream" );
+	}
 
-			// split the buffer
-			size_t j = 0;
-			for ( auto it = w.begin(); it != w.end(); ++it, ++j )
-			{
-				fields[j] = 0;
-				for ( int k = 0; k < *it; ++k )
-				{
-					fields[j] = fields[j] << 8;
-					fields[j] += *ptr++;
-				}
-			}
+	// decode the whole stream in one pass
+	auto data = streamObj.stream_data()->readAll();
+	const uint8_t *ptr = data.buffer.get();
+	const uint8_t *end = ptr + data.length;
 
-			switch ( fields[0] )
+	for ( auto &range : index ) // for each range
+	{
+		auto entry = [&]( size_t i_index, int i_type, int i_field1,
+		                  int i_field2 ) {
+			int i = range.objNb + (int)i_index;
+			switch ( i_type )
 			{
 				case 0: // not used
 					break;
@@ -521,7 +614,7 @@ void Parser::readCrossReferenceStream( Object::dictionary &o_trailerDict,
 				{
 					_doc->xrefTable().expand( i + 1 );
 					if ( _doc->xrefTable()[i].generation() == -1 )
-						_doc->xrefTable()[i] = XRef( fields[2], fields[1] );
+						_doc->xrefTable()[i] = XRef( i_field2, i_field1 );
 					break;
 				}
 				case 2: // entry for an object in a compressed object stream
@@ -530,7 +623,7 @@ void Parser::readCrossReferenceStream( Object::dictionary &o_trailerDict,
 					if ( _doc->xrefTable()[i].generation() == -1 )
 					{
 						_doc->xrefTable()[i] =
-						    XRef( fields[1], fields[2], true );
+						    XRef( i_field1, i_field2, true );
 					}
 					break;
 				}
@@ -538,6 +631,33 @@ void Parser::readCrossReferenceStream( Object::dictionary &o_trailerDict,
 					log_warn() << "bad XRef stream";
 					break;
 			}
+		};
+
+		// the common layouts have their own kernel
+		size_t count = std::max( range.nbOfEntry, 0 );
+		switch ( w.size() == 3 ? xrefLayout( w[0], w[1], w[2] ) : -1 )
+		{
+			case xrefLayout( 1, 2, 1 ):
+				decodeXRefStream<1, 2, 1>( ptr, end, count, entry );
+				break;
+			case xrefLayout( 1, 2, 2 ):
+				decodeXRefStream<1, 2, 2>( ptr, end, count, entry );
+				break;
+			case xrefLayout( 1, 3, 1 ):
+				decodeXRefStream<1, 3, 1>( ptr, end, count, entry );
+				break;
+			case xrefLayout( 1, 3, 2 ):
+				decodeXRefStream<1, 3, 2>( ptr, end, count, entry );
+				break;
+			case xrefLayout( 1, 4, 1 ):
+				decodeXRefStream<1, 4, 1>( ptr, end, count, entry );
+				break;
+			case xrefLayout( 1, 4, 2 ):
+				decodeXRefStream<1, 4, 2>( ptr, end, count, entry );
+				break;
+			default:
+				decodeXRefStream( w, ptr, end, count, entry );
+				break;
 		}
 	}
 
@@ -591,9 +711,14 @@ Object Parser::readObject( int i_id )
 	return {};
 }
 
+Object Parser::readDirectObject()
+{
+	return readObject_priv( 0, 0 );
+}
+
 Parser::ObjectStreamData Parser::readCompressedObjectStream(
     int i_streamId,
-    std::vector<ObjectStreamIndex> &o_compressedObjectStreamIndex )
+    std::vector<ObjectStreamIndex> *o_compressedObjectStreamIndex )
 {
 	auto compressedObjectStream = readObject( i_streamId );
 	if ( not compressedObjectStream.is_stream() )
@@ -612,39 +737,20 @@ Parser::ObjectStreamData Parser::readCompressedObjectStream(
 		return {};
 	int first = First.int_value();
 
-	auto data = compressedObjectStream.stream_data();
-	std::unique_ptr<char[]> dataBuffer;
-	size_t s = 0, cap = 0;
-	for ( ;; )
-	{
-		uint8_t buffer[4096];
-		auto len = data->read( {buffer, 4096} );
-		if ( len <= 0 )
-			break;
-
-		if ( ( s + len ) > cap )
-		{
-			auto newCap = std::max<size_t>( s + len, cap * 2 );
-			auto newData = std::make_unique<char[]>( newCap );
-			memcpy( newData.get(), dataBuffer.get(), s );
-			dataBuffer = std::move( newData );
-			cap = newCap;
-		}
-		memcpy( dataBuffer.get() + s, buffer, len );
-		s += len;
-	}
-	auto compressedObjectData = ObjectStreamData{std::move( dataBuffer ), s};
+	auto data = compressedObjectStream.stream_data()->readAll();
+	size_t s = data.length;
+	auto compressedObjectData = ObjectStreamData{std::move( data.buffer ), s};
+	if ( o_compressedObjectStreamIndex == nullptr )
+		return compressedObjectData;
 
-	su::membuf buf( compressedObjectData.data.get(),
-	                compressedObjectData.data.get() + s );
-	std::istream istr( &buf );
-	Tokenizer tokenizer( istr );
+	auto ptr = (const char *)compressedObjectData.data.get();
+	Tokenizer tokenizer( ptr, ptr + s );
 	for ( int i = 0; i < n; ++i )
 	{
 		Token token1, token2;
 		if ( tokenizer.nextTokenOptional( token1, Token::tok_int ) and
 		     tokenizer.nextTokenOptional( token2, Token::tok_int ) )
-			o_compressedObjectStreamIndex.push_back( ObjectStreamIndex{
+			o_compressedObjectStreamIndex->push_back( ObjectStreamIndex{
 			    token1.intValue(), (size_t)token2.intValue() + first} );
 		else
 			return ObjectStreamData{};
@@ -654,53 +760,80 @@ Parser::ObjectStreamData Parser::readCompressedObjectStream(
 
 Object Parser::readCompressedObject( int i_streamId, int i_indexInStream )
 {
-	ObjectStreamData compressedObjectData;
-	std::vector<ObjectStreamIndex>
-	    compressedObjectStreamIndex; // maps ids -> offsets, use a vector
-	                                 // because we need to preserve the order
-	                                 // too
-
-	auto compressedStream = _compressedObjects.find( i_streamId );
-	if ( compressedStream == _compressedObjects.end() )
-	{
-		// init the stream
-		compressedObjectData = readCompressedObjectStream(
-		    i_streamId, compressedObjectStreamIndex );
+	auto compressedStream = _objectStreams.find( i_streamId );
+	if ( compressedStream == _objectStreams.end() )
+	{
+		// init the stream, parse all its objects, they are usually all needed
+		ObjectStream objectStream;
+		auto compressedObjectData =
+		    readCompressedObjectStream( i_streamId, &objectStream.index );
 		if ( compressedObjectData.data.get() == nullptr )
 			return {};
-		_compressedObjects[i_streamId].resize(
-		    compressedObjectStreamIndex.size() );
-		compressedStream = _compressedObjects.find( i_streamId );
+		objectStream.objects.resize( objectStream.index.size() );
+
+		auto ptr = (const char *)compressedObjectData.data.get();
+		Parser parser( ptr, ptr + compressedObjectData.size, _doc );
+		int index = 0;
+		for ( auto &it : objectStream.index )
+			objectStream.objects[index++] = parser.readObjectStreamEntry( it );
+
+		_objectStreams[i_streamId] = std::move( objectStream );
+		compressedStream = _objectStreams.find( i_streamId );
+		_lastObjectStreamId = i_streamId;
+		_lastObjectStreamData = std::move( compressedObjectData );
 	}
 
-	if ( i_indexInStream >= compressedStream->second.size() )
+	auto &objectStream = compressedStream->second;
+	if ( i_indexInStream >= objectStream.index.size() )
 		return {};
+	if ( objectStream.objects.empty() )
+		objectStream.objects.resize( objectStream.index.size() );
 
-	auto obj = compressedStream->second[i_indexInStream];
+	auto &obj = objectStream.objects[i_indexInStream];
 	if ( obj.is_null() )
 	{
-		// missing object
-		if ( compressedObjectData.data.get() != nullptr )
+		// released or invalid, re-parse it alone with the index we have
+		if ( _lastObjectStreamId != i_streamId or
+		     _lastObjectStreamData.data.get() == nullptr )
 		{
-			assert( compressedObjectStreamIndex.size() ==
-			        compressedStream->second.size() );
-			su::membuf buf(
-			    compressedObjectData.data.get(),
-			    compressedObjectData.data.get() + compressedObjectData.size );
-			std::istream istr( &buf );
-			Parser parser( istr, _doc ); // ?
-
-			int index = 0;
-			for ( auto &it : compressedObjectStreamIndex )
-			{
-				parser._tokenizer.seekg( it.offset, std::ios_base::beg );
-				compressedStream->second[index++] =
-				    parser.readObject_priv( 0, 0 );
-			}
+			_lastObjectStreamData =
+			    readCompressedObjectStream( i_streamId, nullptr );
+			_lastObjectStreamId = i_streamId;
+		}
+		if ( _lastObjectStreamData.data.get() != nullptr )
+		{
+			auto ptr = (const char *)_lastObjectStreamData.data.get();
+			Parser parser( ptr, ptr + _lastObjectStreamData.size, _doc );
+			obj = parser.readObjectStreamEntry(
+			    objectStream.index[i_indexInStream] );
 		}
 	}
 
-	return compressedStream->second[i_indexInStream];
+	return obj;
+}
+
+Object Parser::readObjectStreamEntry( const ObjectStreamIndex &i_entry )
+{
+	try
+	{
+		_tokenizer.seekg( i_entry.offset, std::ios_base::beg );
+		return readObject_priv( 0, 0 );
+	}
+	catch ( std::exception &ex )
+	{
+		log_warn() << ex.what() << " for compressed object " << i_entry.objNb;
+	}
+	return {};
+}
+
+void Parser::releaseObjectStreams()
+{
+	for ( auto &it : _objectStreams )
+	{
+		it.second.objects.clear();
+		it.second.objects.shrink_to_fit();
+	}
+	_lastObjectStreamData = {};
 }
 
 Object Parser::readObject_priv( int i_id, int i_gen )
@@ -732,8 +865,13 @@ Object Parser::readObject_priv( int i_id, int i_gen )
 		case Token::tok_float:
 			return Object::create_number( token.floatValue() );
 		case Token::tok_string:
-			return Object::create_string(
-			    _doc->decrypt( token.value(), i_id, i_gen ) );
+			if ( i_id != 0 and _doc->_securityHandler.get() != nullptr )
+			{
+				return Object::create_string(
+				    _doc,
+				    _doc->decrypt( std::string( token.value() ), i_id, i_gen ) );
+			}
+			return Object::create_string( _doc, token.value() );
 		case Token::tok_name:
 			return Object::create_name( token.value() );
 		case Token::tok_openarray:
@@ -758,32 +896,47 @@ Object Parser::readObject_priv( int i_id, int i_gen )
 				if ( not _tokenizer.nextTokenOptional( token,
 				                                       Token::tok_name ) )
 					break;
-				dict[token.value()] = readObject_priv( i_id, i_gen );
+				dict[Name( token.value() )] = readObject_priv( i_id, i_gen );
 				_tokenizer.nextTokenForced( token );
 			}
 			if ( _tokenizer.nextTokenOptional( token, Token::tok_stream ) )
 			{
-				size_t len, p = _tokenizer.tellg();
-				try
+				static const Name kLength( "Length" );
+				size_t len = 0, p = _tokenizer.tellg();
+				auto recovered = _recoveredLengths.find( p );
+				if ( recovered != _recoveredLengths.end() )
 				{
-					auto it = dict.find( "Length" );
-					len = resolveLength( it != dict.end() ? it->second :
-					                                        Object{} );
+					// bad length, already searched
+					len = recovered->second;
+					dict[kLength] = Object::create_number( (int)len );
 					_tokenizer.seekg( p + len, std::ios_base::beg );
 					_tokenizer.nextTokenForced( token, Token::tok_endstream );
 				}
-				catch ( ... )
+				else
 				{
-					size_t originalLen = len;
+					try
+					{
+						auto it = dict.find( kLength );
+						len = resolveLength(
+						    it != dict.end() ? it->second : Object{} );
+						_tokenizer.seekg( p + len, std::ios_base::beg );
+						_tokenizer.nextTokenForced( token,
+						                            Token::tok_endstream );
+					}
+					catch ( ... )
+					{
+						size_t originalLen = len;
 
-					// search for endstream
-					if ( not guessStreamLength( p, len ) )
-						throw std::runtime_error( "invalid PDF file" );
+						// search for endstream
+						if ( not guessStreamLength( p, len ) )
+							throw std::runtime_error( "invalid PDF file" );
 
-					log_warn() << "invalid stream length of " << originalLen
-					           << " for object " << i_id << " " << i_gen
-					           << "; should be " << len;
-					dict["Length"] = Object::create_number( (int)len );
+						log_warn() << "invalid stream length of "
+						           << originalLen << " for object " << i_id
+						           << " " << i_gen << "; should be " << len;
+						dict[kLength] = Object::create_number( (int)len );
+						_recoveredLengths[p] = len;
+					}
 				}
 				return Object::create_stream(
 				    Object::create_dictionary( _doc, std::move( dict ) ),
@@ -806,70 +959,68 @@ Object Parser::readObject_priv( int i_id, int i_gen )
 
 bool Parser::guessStreamLength( size_t i_streamStart, size_t &o_length )
 {
-	//! @todo: optimise, avoid reading one char at the time
-
-	// look for [\r|\n]endstream[\r|\n]
-
-	_tokenizer.seekg( i_streamStart, std::ios_base::beg );
-	int state = 0; // 0 = start, 1 = [\r|\n], 2 = e, 3 = n, etc dstream,  11 =
-	               // final [\r|\n]
-	while ( _tokenizer and state != 11 )
-	{
-		char c = 0;
-		_tokenizer.read( &c, 1 );
-		if ( c == '\r' or c == '\n' )
+	// look for [\r|\n]endstream[\r|\n], the length include the first eol
+	const std::string_view kEndStream( "endstream" );
+	auto isEOL = []( char c ) { return c == '\r' or c == '\n'; };
+
+	// i_begin is at i_offset in the stream
+	auto search = [&]( const char *i_begin,
+	                   const char *i_end,
+	                   size_t i_offset ) {
+		auto p = i_begin;
+		while ( ( p = findString( p, i_end, kEndStream ) ) != nullptr )
 		{
-			state = state == 10 ? 11 : 1;
+			if ( p > i_begin and isEOL( p[-1] ) and
+			     ( p + kEndStream.size() ) < i_end and
+			     isEOL( p[kEndStream.size()] ) )
+			{
+				o_length = i_offset + ( p - i_begin );
+				return true;
+			}
+			++p;
 		}
-		else
+		return false;
+	};
+
+	bool found = false;
+	auto memory = _tokenizer.memory();
+	if ( memory.data() != nullptr )
+	{
+		if ( i_streamStart < memory.size() )
+			found = search( memory.data() + i_streamStart,
+			                memory.data() + memory.size(),
+			                0 );
+	}
+	else
+	{
+		// blocks overlap by the pattern and its eols, a match at the start of
+		// a block was already checked with the previous one
+		const size_t kOverlap = kEndStream.size() + 1;
+		std::vector<char> block( 64 * 1024 );
+		size_t offset = 0;
+		for ( ;; )
 		{
-			switch ( state )
+			_tokenizer.seekg( i_streamStart + offset, std::ios_base::beg );
+			auto len = _tokenizer.read( block.data(), block.size() );
+			if ( len <= 0 )
+				break;
+			if ( search( block.data(), block.data() + len, offset ) )
 			{
-				case 0:
-					break;
-				case 1:
-					state = c == 'e' ? 2 : 0;
-					break;
-				case 2:
-					state = c == 'n' ? 3 : 0;
-					break;
-				case 3:
-					state = c == 'd' ? 4 : 0;
-					break;
-				case 4:
-					state = c == 's' ? 5 : 0;
-					break;
-				case 5:
-					state = c == 't' ? 6 : 0;
-					break;
-				case 6:
-					state = c == 'r' ? 7 : 0;
-					break;
-				case 7:
-					state = c == 'e' ? 8 : 0;
-					break;
-				case 8:
-					state = c == 'a' ? 9 : 0;
-					break;
-				case 9:
-					state = c == 'm' ? 10 : 0;
-					break;
-				case 10:
-					state = 0;
-					break;
-				default:
-					break;
+				found = true;
+				break;
 			}
+			if ( size_t( len ) < block.size() )
+				break;
+			offset += len - kOverlap;
 		}
 	}
-	if ( state == 11 )
+	if ( found )
 	{
-		size_t current = _tokenizer.tellg();
-		o_length = current - i_streamStart - 10;
-		return true;
+		// just after endstream and its eol
+		_tokenizer.seekg( i_streamStart + o_length + kEndStream.size() + 1,
+		                  std::ios_base::beg );
 	}
-	else
-		return false;
+	return found;
 }
 
 size_t Parser::resolveLength( const Object &i_obj )
@@ -930,12 +1081,6 @@ size_t Parser::resolveLength( const Object &i_obj )
 	return 0;
 }
 
-std::streamoff Parser::read( size_t i_pos, su::array_view<uint8_t> o_buffer )
-{
-	_tokenizer.seekg( i_pos, std::ios_base::beg );
-	return _tokenizer.read( (char *)o_buffer.data(), o_buffer.size() );
-}
-
 bool Parser::isEndOfStream( size_t i_pos )
 {
 	try
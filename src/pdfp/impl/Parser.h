@@ -30,16 +30,32 @@ class Parser
 {
 public:
 	Parser( std::istream &i_str, Document *i_doc );
+	//! parse from memory, the buffer must outlive the parser
+	Parser( const char *i_begin, const char *i_end, Document *i_doc );
 	~Parser() = default;
 
 	Object readXRef( std::string &o_headerVersion );
 	Object buildXRef( std::string &o_headerVersion );
 
 	Object readObject( int i_id );
+	//! parse the direct object at the current position
+	Object readDirectObject();
+
+	//! stream position -> length, for the streams with an invalid length
+	const su::flat_map<size_t, size_t> &recoveredLengths() const
+	{
+		return _recoveredLengths;
+	}
+	void addRecoveredLength( size_t i_pos, size_t i_len )
+	{
+		_recoveredLengths[i_pos] = i_len;
+	}
 
 	void cleanup();
+	//! release the objects of the decoded object streams, they are parsed
+	//! again with the index kept
+	void releaseObjectStreams();
 
-	std::streamoff read( size_t i_pos, su::array_view<uint8_t> o_buffer );
 	bool isEndOfStream( size_t i_pos );
 
 private:
@@ -55,6 +71,10 @@ private:
 	                              std::streamoff &o_xrefpos );
 	void readCrossReferenceStream( Object::dictionary &o_trailerDict,
 	                               std::streamoff &o_xrefpos );
+	//! read the entries of a classic xref subsection that have the fixed
+	//! 20 bytes layout, without the tokenizer, return the number read
+	size_t readFixedXRefEntries( int i_first, int i_count );
+	void setXRefEntry( int i_id, size_t i_pos, int i_gen, bool i_used );
 
 	Object readCompressedObject( int i_streamId,
 	                                                 int i_indexInStream );
@@ -69,14 +89,30 @@ private:
 	};
 	struct ObjectStreamData
 	{
-		std::unique_ptr<char[]> data;
+		std::unique_ptr<uint8_t[]> data;
 		size_t size = 0;
 	};
+	//! decode an object stream, and read its index when o_index is not null
 	ObjectStreamData readCompressedObjectStream(
 	    int i_streamId,
-	    std::vector<ObjectStreamIndex> &o_compressedObjectStreamIndex );
+	    std::vector<ObjectStreamIndex> *o_compressedObjectStreamIndex );
+	//! parse one object of a decoded object stream, null if invalid
+	Object readObjectStreamEntry( const ObjectStreamIndex &i_entry );
+
+	struct ObjectStream
+	{
+		//! the object offsets, kept when the objects are released. A vector
+		//! to preserve the order too
+		std::vector<ObjectStreamIndex> index;
+		std::vector<Object> objects;
+	};
+	su::flat_map<int, ObjectStream> _objectStreams;
+	//! the last object stream decoded, to re-parse its objects one by one
+	int _lastObjectStreamId = 0;
+	ObjectStreamData _lastObjectStreamData;
 
-	su::flat_map<int, std::vector<Object>> _compressedObjects;
+	//! stream position -> length found by guessStreamLength()
+	su::flat_map<size_t, size_t> _recoveredLengths;
 };
 }
 
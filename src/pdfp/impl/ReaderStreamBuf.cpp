@@ -0,0 +1,107 @@
+//
+//  ReaderStreamBuf.cpp
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#include "ReaderStreamBuf.h"
+#include "pdfp/PDFReader.h"
+#include <cstring>
+
+namespace pdfp {
+
+ReaderStreamBuf::ReaderStreamBuf( const RandomAccessReader &i_reader ) :
+    _reader( i_reader )
+{
+	setg( _buffer, _buffer, _buffer );
+}
+
+ReaderStreamBuf::int_type ReaderStreamBuf::underflow()
+{
+	if ( gptr() < egptr() )
+		return traits_type::to_int_type( *gptr() );
+
+	// next block
+	_bufferPos += egptr() - eback();
+	auto len =
+	    _reader.read( _bufferPos, {(uint8_t *)_buffer, sizeof( _buffer )} );
+	if ( len <= 0 )
+	{
+		setg( _buffer, _buffer, _buffer );
+		return traits_type::eof();
+	}
+	setg( _buffer, _buffer, _buffer + len );
+	return traits_type::to_int_type( *gptr() );
+}
+
+std::streamsize ReaderStreamBuf::xsgetn( char_type *s, std::streamsize n )
+{
+	// use what's in the buffer
+	std::streamsize len = std::min<std::streamsize>( n, egptr() - gptr() );
+	memcpy( s, gptr(), len );
+	gbump( (int)len );
+	if ( len == n )
+		return len;
+
+	if ( ( n - len ) < (std::streamsize)sizeof( _buffer ) )
+	{
+		// small read, go through the buffer
+		while ( len < n and underflow() != traits_type::eof() )
+		{
+			auto l = std::min<std::streamsize>( n - len, egptr() - gptr() );
+			memcpy( s + len, gptr(), l );
+			gbump( (int)l );
+			len += l;
+		}
+		return len;
+	}
+
+	// big read, bypass the buffer
+	size_t pos = _bufferPos + ( gptr() - eback() );
+	auto l = _reader.read( pos, {(uint8_t *)s + len, size_t( n - len )} );
+	if ( l > 0 )
+	{
+		pos += l;
+		len += l;
+	}
+	_bufferPos = pos;
+	setg( _buffer, _buffer, _buffer );
+	return len;
+}
+
+ReaderStreamBuf::pos_type ReaderStreamBuf::seekoff(
+    off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which )
+{
+	if ( ( which & std::ios_base::in ) == 0 )
+		return pos_type( off_type( -1 ) );
+
+	off_type target = off;
+	if ( dir == std::ios_base::cur )
+		target += _bufferPos + ( gptr() - eback() );
+	else if ( dir == std::ios_base::end )
+		target += _reader.size();
+	if ( target < 0 )
+		return pos_type( off_type( -1 ) );
+
+	if ( size_t( target ) >= _bufferPos and
+	     size_t( target ) <= _bufferPos + ( egptr() - eback() ) )
+	{
+		// still in the buffer
+		setg( eback(), eback() + ( target - _bufferPos ), egptr() );
+	}
+	else
+	{
+		_bufferPos = target;
+		setg( _buffer, _buffer, _buffer );
+	}
+	return pos_type( target );
+}
+
+ReaderStreamBuf::pos_type ReaderStreamBuf::seekpos(
+    pos_type pos, std::ios_base::openmode which )
+{
+	return seekoff( off_type( pos ), std::ios_base::beg, which );
+}
+}
@@ -0,0 +1,46 @@
+//
+//  ReaderStreamBuf.h
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#ifndef H_PDFP_ReaderStreamBuf
+#define H_PDFP_ReaderStreamBuf
+
+#include <streambuf>
+
+namespace pdfp {
+
+class RandomAccessReader;
+
+/*!
+   @brief buffered, seekable streambuf on top of a RandomAccessReader.
+
+       Let the tokenizer run on any reader.
+*/
+class ReaderStreamBuf : public std::streambuf
+{
+public:
+	ReaderStreamBuf( const RandomAccessReader &i_reader );
+	virtual ~ReaderStreamBuf() = default;
+
+protected:
+	virtual int_type underflow();
+	virtual std::streamsize xsgetn( char_type *s, std::streamsize n );
+	virtual pos_type seekoff( off_type off,
+	                          std::ios_base::seekdir dir,
+	                          std::ios_base::openmode which );
+	virtual pos_type seekpos( pos_type pos, std::ios_base::openmode which );
+
+private:
+	const RandomAccessReader &_reader;
+
+	//! position in the reader of the first byte of the buffer
+	size_t _bufferPos = 0;
+	char _buffer[16 * 1024];
+};
+}
+
+#endif
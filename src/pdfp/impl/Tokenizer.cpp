@@ -8,16 +8,125 @@
  */
 
 #include "Tokenizer.h"
+#include "Keywords.h"
 #include "Utils.h"
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 
+namespace {
+
+//! atoi()/atof() need a null terminated string
+template <typename T, typename F>
+T convertNumber( const std::string_view &i_str, F i_convert )
+{
+	char buf[32];
+	if ( i_str.size() < sizeof( buf ) )
+	{
+		memcpy( buf, i_str.data(), i_str.size() );
+		buf[i_str.size()] = 0;
+		return i_convert( buf );
+	}
+	return i_convert( std::string( i_str ).c_str() );
+}
+
+inline bool isDigit( char c )
+{
+	return unsigned( c - '0' ) <= 9;
+}
+
+//! exactly representable as double
+const double kPowersOf10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                              1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                              1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                              1e18, 1e19, 1e20, 1e21, 1e22};
+
+/*!
+   @brief parse a PDF number in place.
+
+       [-]digits[.digits] or [-].digits, stops at the first character that
+   doesn't fit.
+   @param io_ptr start of the number, on return the end of the number
+   @return false if no digit found
+*/
+bool parseNumber( const char *&io_ptr,
+                  const char *i_end,
+                  bool &o_isInt,
+                  int &o_intVal,
+                  float &o_floatVal )
+{
+	auto p = io_ptr;
+	bool neg = false;
+	if ( p < i_end and *p == '-' )
+	{
+		neg = true;
+		++p;
+	}
+
+	uint64_t mantissa = 0;
+	int digits = 0; // significant digits
+	int scale = 0; // digits after the dot
+	bool digitFound = false;
+	auto addDigit = [&]( char c ) {
+		digitFound = true;
+		if ( mantissa == 0 and c == '0' )
+			return;
+		if ( ++digits <= 19 )
+			mantissa = ( mantissa * 10 ) + ( c - '0' );
+	};
+	while ( p < i_end and isDigit( *p ) )
+		addDigit( *p++ );
+	bool isFloat = p < i_end and *p == '.';
+	if ( isFloat )
+	{
+		++p;
+		while ( p < i_end and isDigit( *p ) )
+		{
+			addDigit( *p++ );
+			++scale;
+		}
+	}
+	if ( not digitFound )
+		return false;
+
+	std::string_view str( io_ptr, p - io_ptr );
+	io_ptr = p;
+	if ( isFloat )
+	{
+		o_isInt = false;
+		// one rounding, same result as atof()
+		if ( digits <= 19 and mantissa <= ( uint64_t( 1 ) << 53 ) and
+		     scale <= 22 )
+		{
+			double v = double( mantissa ) / kPowersOf10[scale];
+			o_floatVal = float( neg ? -v : v );
+		}
+		else
+			o_floatVal = convertNumber<float>(
+			    str, []( const char *s ) { return atof( s ); } );
+	}
+	else
+	{
+		o_isInt = true;
+		if ( digits <= 18 )
+		{
+			int64_t v = neg ? -int64_t( mantissa ) : int64_t( mantissa );
+			o_intVal = int( v );
+		}
+		else
+			o_intVal = convertNumber<int>(
+			    str, []( const char *s ) { return atoi( s ); } );
+	}
+	return true;
+}
+}
+
 namespace pdfp {
 
 Token::Token() : _tokenType( tok_invalid ) {}
 
-Token::Token( token_type tok, const std::string &val ) :
+Token::Token( token_type tok, const std::string_view &val ) :
     _tokenType( tok ),
     _value( val )
 {
@@ -25,21 +134,21 @@ Token::Token( token_type tok, const std::string &val ) :
 	        _tokenType != tok_int and _tokenType != tok_float );
 }
 
-Token::Token( const std::string &val, float val2 ) :
+Token::Token( const std::string_view &val, float val2 ) :
     _tokenType( tok_float ),
     _value( val )
 {
 	u._floatValue = val2;
 }
 
-Token::Token( const std::string &val, int val2 ) :
+Token::Token( const std::string_view &val, int val2 ) :
     _tokenType( tok_int ),
     _value( val )
 {
 	u._intValue = val2;
 }
 
-Token::Token( const std::string &val, bool val2 ) :
+Token::Token( const std::string_view &val, bool val2 ) :
     _tokenType( tok_bool ),
     _value( val )
 {
@@ -82,9 +191,25 @@ bool Token::boolValue() const
 		return false;
 }
 
+void Token::keepValue()
+{
+	if ( _storage.empty() )
+	{
+		_storage.assign( _value.data(), _value.size() );
+		_value = {};
+	}
+}
+
 // MARK: -
 
-Tokenizer::Tokenizer( std::istream &str ) : _stream( str ) {}
+Tokenizer::Tokenizer( std::istream &str ) : _stream( &str ) {}
+
+Tokenizer::Tokenizer( const char *i_begin, const char *i_end ) :
+    _begin( i_begin ),
+    _cur( i_begin ),
+    _end( i_end )
+{
+}
 
 bool Tokenizer::nextToken( Token &o_token )
 {
@@ -107,9 +232,7 @@ bool Tokenizer::nextToken( Token &o_token )
 
 			if ( aChar == '%' )
 			{
-				std::string s;
-				readToWhiteSpace( s );
-				s.insert( 0, 1, aChar );
+				auto s = readToWhiteSpace( aChar );
 				if ( s == "%%EOF" )
 				{
 					// %%EOF
@@ -128,9 +251,9 @@ bool Tokenizer::nextToken( Token &o_token )
 				}
 			}
 			else if ( aChar == '+' or aChar == '-' or aChar == '.' or
-			          isdigit( aChar ) )
+			          isDigit( aChar ) )
 			{
-				std::string n;
+				std::string_view n;
 				bool isInt;
 				int intVal;
 				float floatVal;
@@ -146,10 +269,10 @@ bool Tokenizer::nextToken( Token &o_token )
 			}
 			else if ( aChar == '(' )
 			{
-				std::string s;
-				if ( readLiteralString( s ) )
+				_scratch.clear();
+				if ( readLiteralString( _scratch ) )
 				{
-					o_token = Token( Token::tok_string, s );
+					o_token = Token( Token::tok_string, _scratch );
 				}
 				else
 					throw std::runtime_error( "invalid character" );
@@ -164,10 +287,10 @@ bool Tokenizer::nextToken( Token &o_token )
 				else if ( res )
 				{
 					putBackChar( aChar );
-					std::string s;
-					if ( readHexString( s ) )
+					_scratch.clear();
+					if ( readHexString( _scratch ) )
 					{
-						o_token = Token( Token::tok_string, s );
+						o_token = Token( Token::tok_string, _scratch );
 					}
 					else
 						throw std::runtime_error( "invalid character" );
@@ -175,9 +298,7 @@ bool Tokenizer::nextToken( Token &o_token )
 			}
 			else if ( aChar == '/' )
 			{
-				std::string n;
-				readName( n );
-				o_token = Token( Token::tok_name, n );
+				o_token = Token( Token::tok_name, readName() );
 			}
 			else if ( aChar == '[' )
 			{
@@ -197,61 +318,77 @@ bool Tokenizer::nextToken( Token &o_token )
 			}
 			else if ( isalpha( aChar ) )
 			{
-				std::string s;
-				readToDelimiter( s );
-				s.insert( 0, 1, aChar );
-
-				if ( s == "true" )
-					o_token = Token( "true", true );
-				else if ( s == "false" )
-					o_token = Token( "false", false );
-				else if ( s == "stream" )
+				auto s = readToDelimiter( aChar );
+
+				switch ( keyword( s ) )
 				{
-					char c;
-					/*res =*/nextChar( aChar );
-					// skip spaces
-					while ( aChar == ' ' )
-						nextChar( aChar );
-					
-					res = nextChar( c );
-					if ( aChar == 0x0A )
+					case Keyword::kw_true:
+						o_token = Token( "true", true );
+						break;
+					case Keyword::kw_false:
+						o_token = Token( "false", false );
+						break;
+					case Keyword::kw_stream:
 					{
-						putBackChar( c );
-						o_token = Token( Token::tok_stream, "stream" );
-					}
-					else if ( aChar == 0x0D )
-					{
-						if ( c == 0x0A )
-							o_token = Token( Token::tok_stream, "stream" );
-						else
+						char c;
+						/*res =*/nextChar( aChar );
+						// skip spaces
+						while ( aChar == ' ' )
+							nextChar( aChar );
+
+						res = nextChar( c );
+						if ( aChar == 0x0A )
 						{
 							putBackChar( c );
 							o_token = Token( Token::tok_stream, "stream" );
 						}
+						else if ( aChar == 0x0D )
+						{
+							if ( c == 0x0A )
+								o_token = Token( Token::tok_stream, "stream" );
+							else
+							{
+								putBackChar( c );
+								o_token = Token( Token::tok_stream, "stream" );
+							}
+						}
+						else
+							throw std::runtime_error( "invalid character" );
+						break;
 					}
-					else
-						throw std::runtime_error( "invalid character" );
+					case Keyword::kw_endstream:
+						o_token = Token( Token::tok_endstream, s );
+						break;
+					case Keyword::kw_obj:
+						o_token = Token( Token::tok_obj, s );
+						break;
+					case Keyword::kw_endobj:
+						o_token = Token( Token::tok_endobj, s );
+						break;
+					case Keyword::kw_null:
+						o_token = Token( Token::tok_null, s );
+						break;
+					case Keyword::kw_startxref:
+						o_token = Token( Token::tok_startxref, s );
+						break;
+					case Keyword::kw_xref:
+						o_token = Token( Token::tok_xref, s );
+						break;
+					case Keyword::kw_trailer:
+						o_token = Token( Token::tok_trailer, s );
+						break;
+					default:
+						o_token = Token( Token::tok_command, s );
+						break;
 				}
-				else if ( s == "endstream" )
-					o_token = Token( Token::tok_endstream, s );
-				else if ( s == "obj" )
-					o_token = Token( Token::tok_obj, s );
-				else if ( s == "endobj" )
-					o_token = Token( Token::tok_endobj, s );
-				else if ( s == "null" )
-					o_token = Token( Token::tok_null, s );
-				else if ( s == "startxref" )
-					o_token = Token( Token::tok_startxref, s );
-				else if ( s == "xref" )
-					o_token = Token( Token::tok_xref, s );
-				else if ( s == "trailer" )
-					o_token = Token( Token::tok_trailer, s );
-				else
-					o_token = Token( Token::tok_command, s );
 			}
 			else if ( res )
 				throw std::runtime_error( "invalid character" );
 		} while ( o_token.type() == Token::tok_invalid and res );
+
+		// values read from a stream or decoded live in _scratch
+		if ( _stream != nullptr or o_token.value().data() == _scratch.data() )
+			o_token.keepValue();
 		return res;
 	}
 }
@@ -269,7 +406,7 @@ void Tokenizer::nextTokenForced( Token &o_token,
 	nextTokenForced( o_token );
 	if ( o_token.type() != forcedToken )
 		throw std::runtime_error( std::string( "invalid token : " ) +
-		                          o_token.value() );
+		                          std::string( o_token.value() ) );
 }
 
 bool Tokenizer::nextTokenOptional( Token &o_token,
@@ -296,16 +433,28 @@ void Tokenizer::putBack( const Token &i_token )
 void Tokenizer::invalidToken( const Token &i_token ) const
 {
 	throw std::runtime_error( std::string( "invalid token : " ) +
-	                          i_token.value() );
+	                          std::string( i_token.value() ) );
 }
 
 void Tokenizer::putBackChar( char val )
 {
-	_putbackCharList.push( val );
+	if ( _stream == nullptr )
+	{
+		// the character is still in the buffer
+		if ( _pastEnd )
+			_pastEnd = false;
+		else
+			--_cur;
+	}
+	else
+		_putbackCharList.push( val );
 }
 
 bool Tokenizer::nextNonSpaceChar( char &o_char )
 {
+	if ( _stream == nullptr )
+		_cur = skipWhiteSpace( _cur, _end );
+
 	bool res;
 	do
 	{
@@ -316,6 +465,20 @@ bool Tokenizer::nextNonSpaceChar( char &o_char )
 
 bool Tokenizer::nextChar( char &o_char )
 {
+	if ( _stream == nullptr )
+	{
+		if ( _cur < _end )
+		{
+			o_char = *_cur++;
+			_pastEnd = false;
+			return true;
+		}
+		o_char = 0;
+		_pastEnd = true;
+		_good = false;
+		return false;
+	}
+
 	if ( not _putbackCharList.empty() )
 	{
 		o_char = _putbackCharList.top();
@@ -324,9 +487,9 @@ bool Tokenizer::nextChar( char &o_char )
 	}
 
 	o_char = 0;
-	if ( _stream )
+	if ( *_stream )
 	{
-		int val = _stream.get();
+		int val = _stream->get();
 		if ( val == EOF )
 			return false;
 		o_char = val;
@@ -335,7 +498,7 @@ bool Tokenizer::nextChar( char &o_char )
 	}
 	else
 	{
-		if ( _stream.eof() )
+		if ( _stream->eof() )
 			return false;
 		else
 			throw std::runtime_error( "unknown error" );
@@ -396,14 +559,45 @@ bool Tokenizer::readName( std::string &o_str )
 	return true;
 }
 
-bool Tokenizer::readToWhiteSpace( std::string &o_str )
+std::string_view Tokenizer::readName()
+{
+	if ( _stream == nullptr )
+	{
+		// point in the buffer, unless the name need decoding
+		auto start = _cur;
+		_cur = findWhiteSpaceOrDelimiter( _cur, _end );
+		if ( memchr( start, '#', _cur - start ) != nullptr )
+		{
+			_cur = start;
+			_scratch.clear();
+			readName( _scratch );
+			return _scratch;
+		}
+		return std::string_view( start, _cur - start );
+	}
+
+	_scratch.clear();
+	readName( _scratch );
+	return _scratch;
+}
+
+std::string_view Tokenizer::readToWhiteSpace( char i_first )
 {
+	if ( _stream == nullptr )
+	{
+		// i_first is just before _cur
+		auto start = _cur - 1;
+		_cur = findWhiteSpace( _cur, _end );
+		return std::string_view( start, _cur - start );
+	}
+
+	_scratch.assign( 1, i_first );
 	for ( ;; )
 	{
 		char aChar;
 		bool res = nextChar( aChar );
 		if ( res and not isWhiteSpace( aChar ) )
-			o_str.push_back( aChar );
+			_scratch.push_back( aChar );
 		else
 		{
 			putBackChar( aChar );
@@ -411,19 +605,28 @@ bool Tokenizer::readToWhiteSpace( std::string &o_str )
 		}
 	}
 
-	return true;
+	return _scratch;
 }
 
-bool Tokenizer::readToDelimiter( std::string &o_str )
+std::string_view Tokenizer::readToDelimiter( char i_first )
 {
+	if ( _stream == nullptr )
+	{
+		// i_first is just before _cur
+		auto start = _cur - 1;
+		_cur = findWhiteSpaceOrDelimiter( _cur, _end );
+		return std::string_view( start, _cur - start );
+	}
+
 	bool res;
 	char aChar;
 
+	_scratch.assign( 1, i_first );
 	for ( ;; )
 	{
 		res = nextChar( aChar );
 		if ( res and not isWhiteSpace( aChar ) and not isDelimiter( aChar ) )
-			o_str.push_back( aChar );
+			_scratch.push_back( aChar );
 		else
 		{
 			putBackChar( aChar );
@@ -431,57 +634,61 @@ bool Tokenizer::readToDelimiter( std::string &o_str )
 		}
 	}
 
-	return true;
+	return _scratch;
 }
 
 bool Tokenizer::readNumber( char aChar,
-                               std::string &o_str,
-                               bool &o_isInt,
-                               int &o_intVal,
-                               float &o_floatVal )
+                            std::string_view &o_str,
+                            bool &o_isInt,
+                            int &o_intVal,
+                            float &o_floatVal )
 {
+	if ( _stream == nullptr )
+	{
+		// in memory, parse in place, aChar is just before _cur
+		auto start = _cur - 1;
+		auto p = start;
+		if ( not parseNumber( p, _end, o_isInt, o_intVal, o_floatVal ) )
+			return false;
+		_cur = p;
+		o_str = std::string_view( start, p - start );
+		return true;
+	}
+
+	_scratch.clear();
 	bool res = true;
 	if ( aChar == '-' )
 	{
-		o_str.push_back( aChar );
+		_scratch.push_back( aChar );
 		res = nextChar( aChar );
 	}
-	if ( res and ( aChar == '.' or isdigit( aChar ) ) )
+	if ( res and ( aChar == '.' or isDigit( aChar ) ) )
 	{
-		bool isFloat = false;
-		bool digitFound = false;
-		while ( res and isdigit( aChar ) )
+		while ( res and isDigit( aChar ) )
 		{
-			o_str.push_back( aChar );
-			digitFound = true;
+			_scratch.push_back( aChar );
 			res = nextChar( aChar );
 		}
 		if ( aChar == '.' )
 		{
-			o_str.push_back( aChar );
-			isFloat = true;
+			_scratch.push_back( aChar );
 			res = nextChar( aChar );
-			while ( res and isdigit( aChar ) )
+			while ( res and isDigit( aChar ) )
 			{
-				o_str.push_back( aChar );
-				digitFound = true;
+				_scratch.push_back( aChar );
 				res = nextChar( aChar );
 			}
 		}
 		putBackChar( aChar );
 
-		if ( digitFound )
+		const char *p = _scratch.data();
+		if ( parseNumber( p,
+		                  _scratch.data() + _scratch.size(),
+		                  o_isInt,
+		                  o_intVal,
+		                  o_floatVal ) )
 		{
-			if ( isFloat )
-			{
-				o_isInt = false;
-				o_floatVal = atof( o_str.c_str() );
-			}
-			else
-			{
-				o_isInt = true;
-				o_intVal = atoi( o_str.c_str() );
-			}
+			o_str = _scratch;
 			return true;
 		}
 	}
@@ -591,6 +798,35 @@ bool Tokenizer::readLiteralString( std::string &o_str )
 
 bool Tokenizer::readHexString( std::string &o_str )
 {
+	if ( _stream == nullptr )
+	{
+		// well formed string, decode it in one go
+		auto end = skipHexDigits( _cur, _end );
+		if ( end < _end and *end == '>' )
+		{
+			int v = -1;
+			for ( auto p = _cur; p < end; ++p )
+			{
+				if ( isWhiteSpace( *p ) )
+					continue;
+				int c = *p;
+				int d = c > '9' ? ( tolower( c ) - 'a' + 10 ) : ( c - '0' );
+				if ( v == -1 )
+					v = d;
+				else
+				{
+					o_str.push_back( char( ( v << 4 ) | d ) );
+					v = -1;
+				}
+			}
+			// odd number of digits, the last one is followed by 0
+			if ( v != -1 )
+				o_str.push_back( char( v << 4 ) );
+			_cur = end + 1;
+			return true;
+		}
+	}
+
 	bool res;
 	do
 	{
@@ -619,44 +855,53 @@ bool Tokenizer::readHexString( std::string &o_str )
 	return res;
 }
 
-bool Tokenizer::getLine( std::string &o_line )
-{
-	o_line.clear();
-	while ( not _putbackList.empty() )
-		_putbackList.pop();
-
-	char c;
-	while ( nextChar( c ) )
-	{
-		if ( c == '\n' or c == '\r' )
-			return true;
-		else
-			o_line.push_back( c );
-	}
-	return not o_line.empty();
-}
-
 std::istream::off_type Tokenizer::tellg()
 {
-	return std::istream::off_type( _stream.tellg() ) - _putbackCharList.size();
+	if ( _stream == nullptr )
+		return _good ? _cur - _begin : -1;
+	return std::istream::off_type( _stream->tellg() ) - _putbackCharList.size();
 }
 
 void Tokenizer::seekg( std::istream::off_type p, std::ios_base::seekdir s )
 {
 	while ( not _putbackList.empty() )
 		_putbackList.pop();
+	if ( _stream == nullptr )
+	{
+		if ( s == std::ios_base::cur )
+			p += _cur - _begin;
+		else if ( s == std::ios_base::end )
+			p += _end - _begin;
+		_pastEnd = false;
+		_good = p >= 0 and p <= _end - _begin;
+		if ( _good )
+			_cur = _begin + p;
+		return;
+	}
 	while ( not _putbackCharList.empty() )
 		_putbackCharList.pop();
-	_stream.clear();
-	_stream.seekg( p, s );
+	_stream->clear();
+	_stream->seekg( p, s );
 }
 
 std::streamsize Tokenizer::read( std::istream::char_type *p,
-                                    std::streamsize len )
+                                 std::streamsize len )
 {
 	std::streamsize s = 0;
 	while ( not _putbackList.empty() )
 		_putbackList.pop();
+	if ( _stream == nullptr )
+	{
+		if ( not _good )
+			return 0;
+		s = std::min<std::streamsize>( len, _end - _cur );
+		memcpy( p, _cur, s );
+		_cur += s;
+		_pastEnd = false;
+		if ( s < len )
+			_good = false;
+		return s;
+	}
 	while ( not _putbackCharList.empty() and s != len )
 	{
 		*p = _putbackCharList.top();
@@ -664,7 +909,7 @@ std::streamsize Tokenizer::read( std::istream::char_type *p,
 		++p;
 		++s;
 	}
-	_stream.read( p, len - s );
-	return s + _stream.gcount();
+	_stream->read( p, len - s );
+	return s + _stream->gcount();
 }
 }
@@ -12,6 +12,8 @@
 
 #include <iostream>
 #include <stack>
+#include <string>
+#include <string_view>
 
 namespace pdfp {
 
@@ -48,22 +50,30 @@ public:
 		tok_command // string
 	};
 
+	//! the value is not copied, it must outlive the token, see keepValue()
 	Token();
-	Token( token_type tok, const std::string &val );
-	Token( const std::string &val, float val2 );
-	Token( const std::string &val, int val2 );
-	Token( const std::string &val, bool val2 );
+	Token( token_type tok, const std::string_view &val );
+	Token( const std::string_view &val, float val2 );
+	Token( const std::string_view &val, int val2 );
+	Token( const std::string_view &val, bool val2 );
 	~Token() = default;
 
 	token_type type() const { return _tokenType; }
-	const std::string &value() const { return _value; }
+	std::string_view value() const
+	{
+		return _storage.empty() ? _value : std::string_view( _storage );
+	}
 	float floatValue() const;
 	int intValue() const;
 	bool boolValue() const;
 
+	//! make a copy of the value, for values that don't outlive the token
+	void keepValue();
+
 private:
 	token_type _tokenType; //!< tells which member of the union is valid
-	std::string _value;
+	std::string_view _value; //!< in the source buffer or a literal
+	std::string _storage; //!< decoded or copied value
 	union
 	{
 		float _floatValue;
@@ -76,11 +86,16 @@ private:
    @brief The lexical analyser.
 
        Read a PDF file and return a sequence of lexical token.
+       Can read from a stream, or directly from memory (a file mapping or a
+   decompressed object stream), in which case token values point in the
+   buffer and nothing is copied, except for values that need decoding.
 */
 class Tokenizer
 {
 public:
 	Tokenizer( std::istream &str );
+	//! read from memory, the buffer must outlive the tokenizer and its tokens
+	Tokenizer( const char *i_begin, const char *i_end );
 	~Tokenizer() = default;
 
 	//! get the next token of the stream, return false if no token found
@@ -103,26 +118,44 @@ public:
 	//! throw a parse error
 	void invalidToken( const Token &i_token ) const;
 
-	bool getLine( std::string &o_line );
 	std::istream::off_type tellg();
 	void seekg( std::istream::off_type p, std::ios_base::seekdir s );
 	std::streamsize read( std::istream::char_type *p, std::streamsize len );
-	operator bool() const { return (bool)_stream; }
+	//! the whole source when reading from memory, empty otherwise
+	std::string_view memory() const
+	{
+		return std::string_view( _begin, _end - _begin );
+	}
+	operator bool() const
+	{
+		return _stream != nullptr ? (bool)*_stream : _good;
+	}
 
 private:
-	std::istream &_stream;
+	std::istream *_stream = nullptr;
+
+	// memory source
+	const char *_begin = nullptr;
+	const char *_cur = nullptr;
+	const char *_end = nullptr;
+	bool _good = true; //!< same meaning as the stream state
+	bool _pastEnd = false; //!< last nextChar() hit the end
 
 	std::stack<Token> _putbackList;
 	std::stack<char> _putbackCharList;
 
+	//! storage for token values, when reading from a stream
+	std::string _scratch;
+
 	bool nextNonSpaceChar( char &o_char );
 	bool nextChar( char &o_char );
 	void putBackChar( char val );
-	bool readToWhiteSpace( std::string &o_str );
-	bool readToDelimiter( std::string &o_str );
+	std::string_view readToWhiteSpace( char i_first );
+	std::string_view readToDelimiter( char i_first );
 	bool readName( std::string &o_str );
+	std::string_view readName();
 	bool readNumber( char aChar,
-	                 std::string &o_str,
+	                 std::string_view &o_str,
 	                 bool &o_isInt,
 	                 int &o_intVal,
 	                 float &o_floatVal );
@@ -10,8 +10,237 @@
 #ifndef H_PDFP_UTILS
 #define H_PDFP_UTILS
 
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined( __SSE2__ ) or defined( _M_X64 ) or \
+    ( defined( _M_IX86_FP ) and _M_IX86_FP >= 2 )
+#	define PDFP_SCAN_SSE2 1
+#	include <emmintrin.h>
+#endif
+#if defined( __AVX2__ )
+#	define PDFP_SCAN_AVX2 1
+#	include <immintrin.h>
+#endif
+#if defined( _MSC_VER )
+#	include <intrin.h>
+#endif
+
 namespace pdfp {
 
+//! character classes, as defined in the PDFReference
+enum : uint8_t
+{
+	kClassWhiteSpace = 1,
+	kClassDelimiter = 2,
+	kClassHexDigit = 4
+};
+
+namespace details {
+
+constexpr std::array<uint8_t, 256> makeCharClassTable()
+{
+	std::array<uint8_t, 256> table{};
+	for ( int c : {0x00, 0x09, 0x0A, 0x0C, 0x0D, 0x20} )
+		table[c] |= kClassWhiteSpace;
+	for ( int c : {'(', ')', '<', '>', '[', ']', '{', '}', '/', '%'} )
+		table[c] |= kClassDelimiter;
+	for ( int c = '0'; c <= '9'; ++c )
+		table[c] |= kClassHexDigit;
+	for ( int c = 'a'; c <= 'f'; ++c )
+	{
+		table[c] |= kClassHexDigit;
+		table[c - 'a' + 'A'] |= kClassHexDigit;
+	}
+	return table;
+}
+
+inline constexpr std::array<uint8_t, 256> kCharClass = makeCharClassTable();
+
+inline int countTrailingZeros( uint32_t v )
+{
+#if defined( _MSC_VER )
+	unsigned long r;
+	_BitScanForward( &r, v );
+	return (int)r;
+#else
+	return __builtin_ctz( v );
+#endif
+}
+
+#if PDFP_SCAN_SSE2
+struct Simd128
+{
+	using reg = __m128i;
+	static constexpr int kSize = 16;
+	static reg load( const char *p ) { return _mm_loadu_si128( (const reg *)p ); }
+	static reg set1( char c ) { return _mm_set1_epi8( c ); }
+	static reg zero() { return _mm_setzero_si128(); }
+	static reg eq( reg a, reg b ) { return _mm_cmpeq_epi8( a, b ); }
+	static reg or_( reg a, reg b ) { return _mm_or_si128( a, b ); }
+	static reg and_( reg a, reg b ) { return _mm_and_si128( a, b ); }
+	static reg sub( reg a, reg b ) { return _mm_sub_epi8( a, b ); }
+	static reg min( reg a, reg b ) { return _mm_min_epu8( a, b ); }
+	static uint32_t mask( reg a ) { return (uint32_t)_mm_movemask_epi8( a ); }
+};
+#endif
+#if PDFP_SCAN_AVX2
+struct Simd256
+{
+	using reg = __m256i;
+	static constexpr int kSize = 32;
+	static reg load( const char *p )
+	{
+		return _mm256_loadu_si256( (const reg *)p );
+	}
+	static reg set1( char c ) { return _mm256_set1_epi8( c ); }
+	static reg zero() { return _mm256_setzero_si256(); }
+	static reg eq( reg a, reg b ) { return _mm256_cmpeq_epi8( a, b ); }
+	static reg or_( reg a, reg b ) { return _mm256_or_si256( a, b ); }
+	static reg and_( reg a, reg b ) { return _mm256_and_si256( a, b ); }
+	static reg sub( reg a, reg b ) { return _mm256_sub_epi8( a, b ); }
+	static reg min( reg a, reg b ) { return _mm256_min_epu8( a, b ); }
+	static uint32_t mask( reg a ) { return (uint32_t)_mm256_movemask_epi8( a ); }
+};
+#endif
+
+//! 0xFF in each byte of a register that is in one of the CLASSES
+template <typename S, uint8_t CLASSES>
+inline typename S::reg classify( typename S::reg v )
+{
+	auto r = S::zero();
+	if constexpr ( ( CLASSES & kClassWhiteSpace ) != 0 )
+	{
+		for ( char c : {0x00, 0x09, 0x0A, 0x0C, 0x0D, 0x20} )
+			r = S::or_( r, S::eq( v, S::set1( c ) ) );
+	}
+	if constexpr ( ( CLASSES & kClassDelimiter ) != 0 )
+	{
+		for ( char c : {'(', ')', '<', '>', '[', ']', '{', '}', '/', '%'} )
+			r = S::or_( r, S::eq( v, S::set1( c ) ) );
+	}
+	if constexpr ( ( CLASSES & kClassHexDigit ) != 0 )
+	{
+		// unsigned range checks: c - first <= last - first
+		auto d = S::sub( v, S::set1( '0' ) );
+		r = S::or_( r, S::eq( S::min( d, S::set1( 9 ) ), d ) );
+		auto a = S::sub( S::or_( v, S::set1( 0x20 ) ), S::set1( 'a' ) );
+		r = S::or_( r, S::eq( S::min( a, S::set1( 5 ) ), a ) );
+	}
+	return r;
+}
+
+//! scan whole registers, return nullptr if nothing found
+template <typename S, uint8_t CLASSES, bool IN>
+inline const char *scanBlocks( const char *&io_ptr, const char *i_end )
+{
+	while ( i_end - io_ptr >= S::kSize )
+	{
+		uint32_t m = S::mask( classify<S, CLASSES>( S::load( io_ptr ) ) );
+		if constexpr ( not IN )
+			m = ~m & uint32_t( ( uint64_t( 1 ) << S::kSize ) - 1 );
+		if ( m != 0 )
+			return io_ptr + countTrailingZeros( m );
+		io_ptr += S::kSize;
+	}
+	return nullptr;
+}
+
+//! compare the first and last characters of i_str for a whole register of
+//! positions, then check the candidates
+template <typename S>
+inline const char *findStringBlocks( const char *&io_ptr,
+                                     const char *i_end,
+                                     const std::string_view &i_str )
+{
+	auto first = S::set1( i_str.front() );
+	auto last = S::set1( i_str.back() );
+	size_t n = i_str.size();
+	while ( size_t( i_end - io_ptr ) >= n - 1 + S::kSize )
+	{
+		auto f = S::eq( S::load( io_ptr ), first );
+		auto l = S::eq( S::load( io_ptr + n - 1 ), last );
+		uint32_t m = S::mask( S::and_( f, l ) );
+		while ( m != 0 )
+		{
+			auto p = io_ptr + countTrailingZeros( m );
+			if ( memcmp( p + 1, i_str.data() + 1, n - 2 ) == 0 )
+				return p;
+			m &= m - 1;
+		}
+		io_ptr += S::kSize;
+	}
+	return nullptr;
+}
+}
+
+/*!
+   @brief find the first character in or out of a class.
+
+       Scan 16 or 32 bytes at a time when SSE2 or AVX2 is available.
+   @param i_ptr start of the range
+   @param i_end end of the range
+   @return the first character that is (IN == true) or is not (IN == false)
+   in one of the CLASSES, i_end if none
+*/
+template <uint8_t CLASSES, bool IN>
+inline const char *scanChars( const char *i_ptr, const char *i_end )
+{
+	// most tokens are short, try the first characters one at a time
+	for ( int i = 0; i < 4 and i_ptr < i_end; ++i, ++i_ptr )
+	{
+		if ( ( ( details::kCharClass[uint8_t( *i_ptr )] & CLASSES ) != 0 ) ==
+		     IN )
+			return i_ptr;
+	}
+#if PDFP_SCAN_AVX2
+	if ( auto p = details::scanBlocks<details::Simd256, CLASSES, IN>( i_ptr,
+	                                                                  i_end ) )
+		return p;
+#endif
+#if PDFP_SCAN_SSE2
+	if ( auto p = details::scanBlocks<details::Simd128, CLASSES, IN>( i_ptr,
+	                                                                  i_end ) )
+		return p;
+#endif
+	while ( i_ptr < i_end and
+	        ( ( details::kCharClass[uint8_t( *i_ptr )] & CLASSES ) != 0 ) !=
+	            IN )
+		++i_ptr;
+	return i_ptr;
+}
+
+/*!
+   @brief find a string in [i_ptr, i_end).
+
+       Vectorized first/last character filter when SSE2 or AVX2 is
+   available.
+   @return the start of the first occurrence, nullptr if not found
+*/
+inline const char *findString( const char *i_ptr,
+                               const char *i_end,
+                               const std::string_view &i_str )
+{
+#if PDFP_SCAN_AVX2 or PDFP_SCAN_SSE2
+	if ( i_str.size() >= 2 )
+	{
+#	if PDFP_SCAN_AVX2
+		if ( auto p = details::findStringBlocks<details::Simd256>(
+		         i_ptr, i_end, i_str ) )
+			return p;
+#	endif
+		if ( auto p = details::findStringBlocks<details::Simd128>(
+		         i_ptr, i_end, i_str ) )
+			return p;
+	}
+#endif
+	std::string_view s( i_ptr, i_end - i_ptr );
+	auto p = s.find( i_str );
+	return p == std::string_view::npos ? nullptr : i_ptr + p;
+}
+
 /*!
    @brief define a PDF white space.
 
@@ -22,8 +251,7 @@ namespace pdfp {
 */
 inline bool isWhiteSpace( int c )
 {
-	return ( c == 0 or c == 0x09 or c == 0x0A or c == 0x0C or c == 0x0D or
-	         c == 0x20 );
+	return ( details::kCharClass[uint8_t( c )] & kClassWhiteSpace ) != 0;
 }
 
 /*!
@@ -36,8 +264,35 @@ inline bool isWhiteSpace( int c )
 */
 inline bool isDelimiter( int c )
 {
-	return ( c == '(' or c == ')' or c == '<' or c == '>' or c == '[' or
-	         c == ']' or c == '{' or c == '}' or c == '/' or c == '%' );
+	return ( details::kCharClass[uint8_t( c )] & kClassDelimiter ) != 0;
+}
+
+//! first character in [i_ptr, i_end) that is not a white space
+inline const char *skipWhiteSpace( const char *i_ptr, const char *i_end )
+{
+	return scanChars<kClassWhiteSpace, false>( i_ptr, i_end );
+}
+
+//! first white space in [i_ptr, i_end)
+inline const char *findWhiteSpace( const char *i_ptr, const char *i_end )
+{
+	return scanChars<kClassWhiteSpace, true>( i_ptr, i_end );
+}
+
+//! end of a name or a keyword: first white space or delimiter
+inline const char *findWhiteSpaceOrDelimiter( const char *i_ptr,
+                                              const char *i_end )
+{
+	return scanChars<kClassWhiteSpace | kClassDelimiter, true>( i_ptr,
+	                                                            i_end );
+}
+
+//! end of the content of an hex string: first character that is not an hex
+//! digit or a white space
+inline const char *skipHexDigits( const char *i_ptr, const char *i_end )
+{
+	return scanChars<kClassWhiteSpace | kClassHexDigit, false>( i_ptr,
+	                                                            i_end );
 }
 }
 
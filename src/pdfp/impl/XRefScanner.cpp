@@ -0,0 +1,231 @@
+//
+//  XRefScanner.cpp
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#include "XRefScanner.h"
+#include "Utils.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+//! below this, scanning is not worth a thread
+const size_t kMinPartSize = 1024 * 1024;
+
+inline bool isEOL( char c )
+{
+	return c == '\r' or c == '\n';
+}
+
+//! white space inside a line
+inline bool isLineSpace( char c )
+{
+	return c == ' ' or c == '\t' or c == '\v' or c == '\f';
+}
+
+inline bool isDigit( char c )
+{
+	return unsigned( c - '0' ) <= 9;
+}
+
+//! parse the digits before i_end backward, false if none or too big
+bool readIntBackward( const char *i_begin,
+                      const char *&io_ptr,
+                      int &o_value )
+{
+	auto end = io_ptr;
+	while ( io_ptr > i_begin and isDigit( io_ptr[-1] ) )
+		--io_ptr;
+	if ( io_ptr == end or ( end - io_ptr ) > 10 )
+		return false;
+	long long v = 0;
+	for ( auto p = io_ptr; p < end; ++p )
+		v = ( v * 10 ) + ( *p - '0' );
+	if ( v > INT_MAX )
+		return false;
+	o_value = (int)v;
+	return true;
+}
+
+//! skip white spaces backward, return the number of spaces skipped
+size_t skipSpacesBackward( const char *i_begin, const char *&io_ptr )
+{
+	auto end = io_ptr;
+	while ( io_ptr > i_begin and isLineSpace( io_ptr[-1] ) )
+		--io_ptr;
+	return end - io_ptr;
+}
+
+/*!
+   @brief check that "obj" at i_obj is the end of ^\s*\d+\s+\d+\s+obj
+
+   @param o_lineStart start of the line
+*/
+bool isObjDef( const char *i_begin,
+               const char *i_end,
+               const char *i_obj,
+               int &o_num,
+               int &o_gen,
+               const char *&o_lineStart )
+{
+	// followed by end of line, white space or delimiter
+	auto after = i_obj + 3;
+	if ( after < i_end and not pdfp::isWhiteSpace( *after ) and
+	     not pdfp::isDelimiter( *after ) )
+		return false;
+
+	auto ptr = i_obj;
+	if ( skipSpacesBackward( i_begin, ptr ) == 0 or
+	     not readIntBackward( i_begin, ptr, o_gen ) or
+	     skipSpacesBackward( i_begin, ptr ) == 0 or
+	     not readIntBackward( i_begin, ptr, o_num ) )
+		return false;
+	skipSpacesBackward( i_begin, ptr );
+	if ( ptr > i_begin and not isEOL( ptr[-1] ) )
+		return false;
+	o_lineStart = ptr;
+	return true;
+}
+
+const char *lineStart( const char *i_begin, const char *i_ptr )
+{
+	while ( i_ptr > i_begin and not isEOL( i_ptr[-1] ) )
+		--i_ptr;
+	return i_ptr;
+}
+
+const char *lineEnd( const char *i_ptr, const char *i_end )
+{
+	while ( i_ptr < i_end and not isEOL( *i_ptr ) )
+		++i_ptr;
+	return i_ptr;
+}
+
+}
+
+namespace pdfp {
+
+void XRefScanner::scan( const char *i_begin, const char *i_end, size_t i_pos )
+{
+	size_t size = i_end - i_begin;
+	size_t nbParts = std::min<size_t>( std::thread::hardware_concurrency(),
+	                                   size / kMinPartSize );
+	if ( nbParts <= 1 )
+	{
+		scanPart( i_begin, i_end, i_begin, i_end, i_pos, *this );
+		return;
+	}
+
+	// each part owns the definitions that start in it, but can look
+	// outside for the rest of the line
+	std::vector<XRefScanner> results( nbParts );
+	std::vector<std::thread> threads;
+	size_t partSize = size / nbParts;
+	for ( size_t i = 0; i < nbParts; ++i )
+	{
+		auto from = i_begin + ( i * partSize );
+		auto to = i == ( nbParts - 1 ) ? i_end : from + partSize;
+		threads.emplace_back( [=, &results]() {
+			scanPart( i_begin, i_end, from, to, i_pos, results[i] );
+		} );
+	}
+	for ( auto &it : threads )
+		it.join();
+	for ( auto &it : results )
+		append( std::move( it ) );
+}
+
+void XRefScanner::append( XRefScanner &&i_other )
+{
+	_objects.insert(
+	    _objects.end(), i_other._objects.begin(), i_other._objects.end() );
+	_trailers.insert(
+	    _trailers.end(), i_other._trailers.begin(), i_other._trailers.end() );
+	if ( not i_other._headerVersion.empty() )
+		_headerVersion = std::move( i_other._headerVersion );
+}
+
+void XRefScanner::scanPart( const char *i_begin,
+                            const char *i_end,
+                            const char *i_from,
+                            const char *i_to,
+                            size_t i_pos,
+                            XRefScanner &o_result )
+{
+	// "num gen obj", look for the 'j' and check backward
+	auto ptr = i_from + 2;
+	auto jEnd = std::min( i_to + 2, i_end );
+	while ( ptr < jEnd )
+	{
+		auto j = (const char *)memchr( ptr, 'j', jEnd - ptr );
+		if ( j == nullptr )
+			break;
+		ptr = j + 1;
+		auto obj = j - 2;
+		if ( obj[0] != 'o' or obj[1] != 'b' )
+			continue;
+		int num, gen;
+		const char *start;
+		if ( isObjDef( i_begin, i_end, obj, num, gen, start ) )
+			o_result._objects.push_back(
+			    ObjectDef{num, gen, i_pos + ( start - i_begin )} );
+	}
+
+	// "trailer" at the start of a line
+	const std::string_view kTrailer( "trailer" );
+	ptr = i_from;
+	while ( ptr < i_to )
+	{
+		auto t = findString(
+		    ptr, std::min( i_to + kTrailer.size() - 1, i_end ), kTrailer );
+		if ( t == nullptr )
+			break;
+		ptr = t + 1;
+		if ( t == i_begin or isEOL( t[-1] ) )
+			o_result._trailers.push_back( i_pos + ( t - i_begin ) +
+			                              kTrailer.size() );
+	}
+
+	// "%PDF-x.y" anywhere in a line, first one of the line
+	const std::string_view kHeader( "%PDF-" );
+	ptr = i_from;
+	while ( ptr < i_to )
+	{
+		auto h = findString(
+		    ptr, std::min( i_to + kHeader.size() - 1, i_end ), kHeader );
+		if ( h == nullptr )
+			break;
+		ptr = h + 1;
+		auto start = lineStart( i_begin, h );
+		auto end = lineEnd( h, i_end );
+		if ( findString( start, h, kHeader ) != nullptr or ( end - h ) < 8 or
+		     not isDigit( h[5] ) )
+			continue;
+
+		// not on a trailer or an object definition line
+		std::string_view line( start, end - start );
+		if ( line.compare( 0, kTrailer.size(), kTrailer ) == 0 )
+			continue;
+		bool objDef = false;
+		for ( auto o = findString( start, end, "obj" ); o != nullptr;
+		      o = findString( o + 1, end, "obj" ) )
+		{
+			int num, gen;
+			const char *s;
+			if ( isObjDef( i_begin, i_end, o, num, gen, s ) )
+				objDef = true;
+		}
+		if ( objDef )
+			continue;
+
+		o_result._headerVersion.assign( h + 5, end );
+	}
+}
+}
@@ -0,0 +1,70 @@
+//
+//  XRefScanner.h
+//  pdfp
+//
+//  Created by Sandy Martel on 2026/10/17.
+//
+//
+
+#ifndef H_PDFP_XRefScanner
+#define H_PDFP_XRefScanner
+
+#include <string>
+#include <vector>
+
+namespace pdfp {
+
+/*!
+   @brief scan the raw bytes of a damaged file for object definitions.
+
+       Look for "num gen obj" and "trailer" at the start of a line and for
+   the "%PDF-" header. Large blocks are split and scanned on several
+   threads, the results are kept in file order.
+*/
+class XRefScanner
+{
+public:
+	struct ObjectDef
+	{
+		int num;
+		int gen;
+		size_t pos; //!< start of the line
+	};
+
+	XRefScanner() = default;
+	~XRefScanner() = default;
+
+	/*!
+	   @brief scan a block of complete lines.
+
+	       Blocks must be given in file order.
+	   @param i_begin start of the block, also the start of a line
+	   @param i_end end of the block, also the end of a line
+	   @param i_pos position of i_begin in the file
+	*/
+	void scan( const char *i_begin, const char *i_end, size_t i_pos );
+
+	//! all object definitions, in file order
+	const std::vector<ObjectDef> &objects() const { return _objects; }
+	//! position just after each "trailer" keyword, in file order
+	const std::vector<size_t> &trailers() const { return _trailers; }
+	//! version from the last header line, empty if none
+	const std::string &headerVersion() const { return _headerVersion; }
+
+private:
+	std::vector<ObjectDef> _objects;
+	std::vector<size_t> _trailers;
+	std::string _headerVersion;
+
+	//! scan the definitions starting in [i_from, i_to)
+	static void scanPart( const char *i_begin,
+	                      const char *i_end,
+	                      const char *i_from,
+	                      const char *i_to,
+	                      size_t i_pos,
+	                      XRefScanner &o_result );
+	void append( XRefScanner &&i_other );
+};
+}
+
+#endif
@@ -7,13 +7,46 @@
 //
 
 #include "XrefTable.h"
+#include <atomic>
 #include <cassert>
 
+namespace {
+
+std::atomic<size_t> gTotalCacheSize{0};
+
+//! memory that eviction would give back, values stored in the Object itself
+//! cost nothing more than the slot
+size_t cost( const pdfp::Object &i_obj )
+{
+	return i_obj.use_count() != 0 ? i_obj.mem_size() : 0;
+}
+}
+
 namespace pdfp {
 
+XrefTable::~XrefTable()
+{
+	account( 0, cacheSize() );
+}
+
 void XrefTable::clear()
 {
 	_table.clear();
+	account( 0, cacheSize() );
+	_clockHand = 0;
+}
+
+size_t XrefTable::totalCacheSize()
+{
+	return gTotalCacheSize.load( std::memory_order_relaxed );
+}
+
+void XrefTable::account( size_t i_add, size_t i_remove ) const
+{
+	_cacheSize.fetch_add( i_add, std::memory_order_relaxed );
+	_cacheSize.fetch_sub( i_remove, std::memory_order_relaxed );
+	gTotalCacheSize.fetch_add( i_add, std::memory_order_relaxed );
+	gTotalCacheSize.fetch_sub( i_remove, std::memory_order_relaxed );
 }
 
 void XrefTable::expand( size_t i_size )
@@ -26,7 +59,8 @@ const Object &XrefTable::registerObject( int i_ref, const Object &i_obj ) const
 {
 	if ( i_ref < _table.size() )
 	{
-		_table[i_ref].setObject( i_obj );
+		if ( _table[i_ref].setObject( i_obj ) )
+			account( cost( i_obj ), 0 );
 		return _table[i_ref].object();
 	}
 	return kObjectNull;
@@ -42,11 +76,46 @@ const Object &XrefTable::resolveRef( int i_ref, int i_gen ) const
 	if ( i_ref >= _table.size() )
 		return kObjectNull;
 	if ( _table[i_ref].compressed() or _table[i_ref].generation() == i_gen )
+	{
+		_table[i_ref].touch();
 		return _table[i_ref].object();
+	}
 	else
 		return kObjectNull;
 }
 
+void XrefTable::trim( size_t i_budget, size_t i_globalBudget )
+{
+	if ( _table.empty() )
+		return;
+
+	// entries replaced while reading the xref are not accounted, start from
+	// the exact size
+	size_t exact = 0;
+	for ( auto &it : _table )
+		exact += cost( it.object() );
+	account( exact, cacheSize() );
+
+	auto overBudget = [&]() {
+		return ( i_budget != 0 and cacheSize() > i_budget ) or
+		       ( i_globalBudget != 0 and totalCacheSize() > i_globalBudget );
+	};
+
+	// CLOCK: a recently used object gets a second chance, so at most 2 turns
+	for ( size_t n = 2 * _table.size(); n > 0 and overBudget(); --n )
+	{
+		auto &slot = _table[_clockHand];
+		_clockHand = ( _clockHand + 1 ) % _table.size();
+
+		// pinned: held by someone else, or nothing to give back
+		const auto &obj = slot.object();
+		if ( obj.use_count() != 1 or slot.untouch() )
+			continue;
+		account( 0, cost( obj ) );
+		slot.evict();
+	}
+}
+
 bool XrefTable::refForObject( const Object &i_obj,
                                   int &o_ref,
                                   int &o_gen ) const
@@ -9,6 +9,7 @@
 #ifndef H_PDFP_XrefTable
 #define H_PDFP_XrefTable
 
+#include <atomic>
 #include <memory>
 #include "pdfp/PDFObject.h"
 
@@ -31,6 +32,24 @@ public:
 	XRef( const Object &i_obj ) :
 	    _object( i_obj )
 	{
+		_loaded.store( not _object.is_null(), std::memory_order_relaxed );
+	}
+	XRef( const XRef &rhs ) :
+	    _compressed( rhs._compressed ),
+	    _generationOrStreamID( rhs._generationOrStreamID ),
+	    _posOrIndex( rhs._posOrIndex ),
+	    _object( rhs.object() )
+	{
+		_loaded.store( not _object.is_null(), std::memory_order_relaxed );
+	}
+	XRef &operator=( const XRef &rhs )
+	{
+		_compressed = rhs._compressed;
+		_generationOrStreamID = rhs._generationOrStreamID;
+		_posOrIndex = rhs._posOrIndex;
+		_object = rhs.object();
+		_loaded.store( not _object.is_null(), std::memory_order_relaxed );
+		return *this;
 	}
 
 	int generation() const { return _generationOrStreamID; }
@@ -41,14 +60,48 @@ public:
 	int streamId() const { return _generationOrStreamID; }
 	int indexInStream() const { return _posOrIndex; }
 
-	void setObject( const Object &i_obj )
+	//! publish the object, a slot is published once: the first non-null
+	//! object stays, a null object leaves the slot empty
+	//! @return true if i_obj was published
+	bool setObject( const Object &i_obj )
 	{
+		if ( loaded() or i_obj.is_null() )
+			return false;
 		_object = i_obj;
+		_loaded.store( true, std::memory_order_release );
+		return true;
+	}
+	//! drop the object, it will be parsed again when needed
+	void evict()
+	{
+		_loaded.store( false, std::memory_order_relaxed );
+		_object.clear();
+	}
+	//! the published object, null until then
+	const Object &object() const
+	{
+		return loaded() ? _object : kObjectNull;
+	}
+	bool loaded() const { return _loaded.load( std::memory_order_acquire ); }
+
+	//! mark as recently used, for the cache eviction
+	void touch() const
+	{
+		if ( not _referenced.load( std::memory_order_relaxed ) )
+			_referenced.store( true, std::memory_order_relaxed );
+	}
+	//! clear the recently used mark, return its previous value
+	bool untouch() const
+	{
+		return _referenced.exchange( false, std::memory_order_relaxed );
 	}
-	const Object &object() const { return _object; }
 
 private:
 	bool _compressed = false;
+	//! _object is set and will not change anymore, it can be read without
+	//! a lock once this is seen
+	std::atomic<bool> _loaded{false};
+	mutable std::atomic<bool> _referenced{false};
 	int _generationOrStreamID = 1; //!< stream ID if _compressed
 	int _posOrIndex = -1; //!< index if _compressed
 
@@ -60,7 +113,10 @@ class XrefTable
 {
 public:
 	XrefTable() = default;
-	~XrefTable() = default;
+	~XrefTable();
+
+	XrefTable( const XrefTable & ) = delete;
+	XrefTable &operator=( const XrefTable & ) = delete;
 
 	void clear();
 
@@ -68,12 +124,33 @@ public:
 
 	void expand( size_t i_size );
 
+	//! publish an object, return the object of the slot: i_obj or the one
+	//! published before
 	const Object &registerObject( int i_ref, const Object &i_obj ) const;
 	void addNewObject( const Object &i_obj ) const;
 
 	const Object &resolveRef( int i_ref, int i_gen ) const;
 	bool refForObject( const Object &i_obj, int &o_ref, int &o_gen ) const;
 
+	//! memory held by the published objects
+	size_t cacheSize() const
+	{
+		return _cacheSize.load( std::memory_order_relaxed );
+	}
+	//! same, for every table
+	static size_t totalCacheSize();
+
+	/*!
+	   @brief evict the objects that nobody else holds, least recently used
+	   first, until under the budgets.
+
+	       The objects evicted are destroyed, the caller must ensure that no
+	   reference to them is held.
+	   @param i_budget for this table, 0 for no limit
+	   @param i_globalBudget for every table, 0 for no limit
+	*/
+	void trim( size_t i_budget, size_t i_globalBudget );
+
 	XRefVector_t::const_iterator begin() const { return _table.begin(); }
 	XRefVector_t::const_iterator end() const { return _table.end(); }
 
@@ -85,6 +162,10 @@ public:
 
 private:
 	mutable XRefVector_t _table;
+	mutable std::atomic<size_t> _cacheSize{0};
+	size_t _clockHand = 0;
+
+	void account( size_t i_add, size_t i_remove ) const;
 };
 }
 
@@ -314,7 +314,7 @@ StandardSecurityHandler::StandardSecurityHandler( const Object &i_encryptDict )
 				else
 					data.length = Length.int_value();
 
-				CF.insert( std::make_pair( it.first, data ) );
+				CF.insert( std::make_pair( it.first.str(), data ) );
 			}
 			auto &StmFObj = i_encryptDict["StmF"];
 			if ( not StmFObj.is_name() )
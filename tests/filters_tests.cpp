@@ -0,0 +1,115 @@
+#include "filters_tests.h"
+#include "pdfp/filters/TIFFPredictor.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+
+class MemorySource : public pdfp::InputSource
+{
+public:
+	MemorySource( std::vector<uint8_t> i_data ) : _data( std::move( i_data ) )
+	{
+	}
+
+	virtual void rewind() { _pos = 0; }
+	virtual std::streamoff read( su::array_view<uint8_t> o_buffer )
+	{
+		if ( _pos >= _data.size() )
+			return EOF;
+		auto l = std::min( o_buffer.size(), _data.size() - _pos );
+		std::copy( _data.begin() + _pos,
+		           _data.begin() + _pos + l,
+		           o_buffer.begin() );
+		_pos += l;
+		return l;
+	}
+
+private:
+	std::vector<uint8_t> _data;
+	size_t _pos = 0;
+};
+
+std::vector<uint8_t> randomBytes( size_t i_len, uint32_t i_seed )
+{
+	std::vector<uint8_t> result( i_len );
+	for ( auto &b : result )
+	{
+		i_seed = i_seed * 1664525 + 1013904223;
+		b = uint8_t( i_seed >> 24 );
+	}
+	return result;
+}
+
+//! sample by sample, the half of a truncated last sample is left as is
+std::vector<uint8_t> decode16( std::vector<uint8_t> i_data,
+                               size_t i_rowBytes,
+                               int i_nbOfComp )
+{
+	for ( size_t p = 0; p < i_data.size(); p += i_rowBytes )
+	{
+		auto row = i_data.data() + p;
+		size_t nbSamples = std::min( i_rowBytes, i_data.size() - p ) / 2;
+		for ( size_t i = i_nbOfComp; i < nbSamples; ++i )
+		{
+			uint16_t v = ( row[2 * i] << 8 ) | row[2 * i + 1];
+			v += ( row[2 * ( i - i_nbOfComp )] << 8 ) |
+			     row[2 * ( i - i_nbOfComp ) + 1];
+			row[2 * i] = uint8_t( v >> 8 );
+			row[2 * i + 1] = uint8_t( v );
+		}
+	}
+	return i_data;
+}
+
+std::vector<uint8_t> readAll( pdfp::InputSource &i_source )
+{
+	std::vector<uint8_t> result;
+	uint8_t buffer[1000];
+	for ( ;; )
+	{
+		auto l = i_source.read( {buffer, sizeof( buffer )} );
+		if ( l <= 0 )
+			break;
+		result.insert( result.end(), buffer, buffer + l );
+	}
+	return result;
+}
+
+//! a last row of odd length, every code path of the 16 bits decoding
+int testTIFF16OddRow()
+{
+	int failures = 0;
+	for ( int nbOfComp : {1, 2, 3, 4, 5} )
+	{
+		for ( size_t width : {1, 7, 33} )
+		{
+			size_t rowBytes = width * nbOfComp * 2;
+			for ( size_t tail = 1; tail < rowBytes; tail += 2 )
+			{
+				auto data = randomBytes( 3 * rowBytes + tail, uint32_t( tail ) );
+				pdfp::TIFFPredictor predictor( width, 16, nbOfComp );
+				predictor.setNext( std::make_unique<MemorySource>( data ) );
+				if ( readAll( predictor ) != decode16( data, rowBytes, nbOfComp ) )
+				{
+					std::cout << "TIFF predictor, 16 bits, " << nbOfComp
+					          << " components, width " << width << ", last row of "
+					          << tail << " bytes: FAILED\n";
+					++failures;
+				}
+			}
+		}
+	}
+	return failures;
+}
+}
+
+int run_filters_tests()
+{
+	int failures = testTIFF16OddRow();
+	std::cout << "filters tests: " << ( failures == 0 ? "ok" : "FAILED" )
+	          << std::endl;
+	return failures;
+}
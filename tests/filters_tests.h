@@ -0,0 +1,8 @@
+#ifndef H_PDFP_FILTERS_TESTS
+#define H_PDFP_FILTERS_TESTS
+
+//! decode crafted data with the filters and compare to a plain decoding,
+//! return the number of failures
+int run_filters_tests();
+
+#endif
@@ -26,6 +26,7 @@
 #endif
 
 #include "dumper.h"
+#include "filters_tests.h"
 
 #include <malloc/malloc.h>
 
@@ -36,9 +37,12 @@ int usage()
 {
 	std::cout << "pdf_tests run_tests [driver list] [file or folder path]\n";
 	std::cout << "or\n";
-	std::cout << "pdf_tests dump [driver] [file path] {-o output_file}\n\n";
+	std::cout << "pdf_tests dump [driver] [file path] {-o output_file}\n";
+	std::cout << "or\n";
+	std::cout << "pdf_tests filters\n\n";
 	std::cout << "supported drivers:\n";
 	std::cout << "  pdfp\n";
+	std::cout << "  pdfp_mapped\n";
 #ifdef PDFP_WANT_QUARTZ
 	std::cout << "  quartz\n";
 #endif
@@ -88,10 +92,12 @@ int dump( const std::string_view &driver,
 	{
 		try
 		{
-			if ( driver == "pdfp" )
+			if ( driver == "pdfp" or driver == "pdfp_mapped" )
 			{
 				auto doc = std::make_unique<pdfp::Document>();
-				doc->open( file );
+				doc->open( file,
+				           driver == "pdfp" ? pdfp::open_mode_t::kStream :
+				                              pdfp::open_mode_t::kMapped );
 				doc->preload();
 				dumpDocument( doc.get(), *output_stream );
 			}
@@ -876,6 +882,10 @@ int main( int argc, char *const argv[] )
 			output = argv[5];
 		return dump( driver, file, output );
 	}
+	else if ( strcmp( argv[1], "filters" ) == 0 )
+	{
+		return run_filters_tests() == 0 ? 0 : 1;
+	}
 	else if ( strcmp( argv[1], "run_tests" ) == 0 and argc >= 3 )
 	{
 		auto input = argv[2];